@@ -0,0 +1,46 @@
+/*
+ * myexit.c - Another handy routine for testing your tiny shell
+ *
+ * usage: myexit <n>
+ * Exits at once with status <n>, or if <n> is negative, is killed by
+ * signal -<n>. If TSH_STORMLOG names a file, first appends a line
+ * "<pid> <ns>" to it with the CLOCK_MONOTONIC time of its death.
+ */
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <signal.h>
+
+int main(int argc, char **argv)
+{
+    struct timespec ts;
+    char buf[64];
+    char *log;
+    int n, fd, len;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <n>\n", argv[0]);
+        exit(0);
+    }
+    n = atoi(argv[1]);
+
+    if ((log = getenv("TSH_STORMLOG")) != NULL
+            && (fd = open(log, O_WRONLY | O_APPEND | O_CREAT, 0644)) >= 0) {
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        len = snprintf(buf, sizeof(buf), "%d %lld\n", (int)getpid(),
+                       ts.tv_sec * 1000000000LL + ts.tv_nsec);
+        if (write(fd, buf, len) != len) {   /* one write, so lines never mix */
+            exit(1);
+        }
+        close(fd);
+    }
+
+    if (n < 0) {
+        signal(-n, SIG_DFL);
+        kill(getpid(), -n);
+    }
+    exit(n);
+}
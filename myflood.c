@@ -0,0 +1,37 @@
+/*
+ * myflood.c - Another handy routine for testing your tiny shell
+ *
+ * usage: myflood <n>
+ * Writes <n> bytes of numbered lines to stdout as fast as it can.
+ */
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char **argv)
+{
+    char buf[65536];
+    long total, left, n;
+    int len, line = 0;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <n>\n", argv[0]);
+        exit(0);
+    }
+    total = atol(argv[1]);
+
+    for (left = total; left > 0; left -= n) {
+        /* fill the buffer with whole lines where possible */
+        for (n = 0; n < (long)sizeof(buf) - 32 && n < left; n += len) {
+            len = sprintf(buf + n, "myflood line %d\n", ++line);
+        }
+        if (n > left) {
+            n = left;
+        }
+        if (write(STDOUT_FILENO, buf, n) != n) {
+            exit(1);
+        }
+    }
+    exit(0);
+}
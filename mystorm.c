@@ -0,0 +1,396 @@
+/*
+ * mystorm.c - Fork-storm and signal-storm stress test of the shell
+ *
+ * usage: mystorm [-s <shell>] [-n <jobs>] [-b <burst>] [-k <jobs>] [-r <rounds>]
+ *
+ * Runs the shell (default ./tsh -p) on a pipe and puts it through two
+ * storms, reading its output as it comes:
+ *
+ * Fork storm: <jobs> background ./myexit jobs in bursts of <burst>,
+ * each burst followed by wait. A quarter of the jobs exit with 0 and
+ * a quarter with 3, a quarter are killed by SIGKILL and a quarter by
+ * SIGTERM. Reports the jobs reaped per second, how many of the signal
+ * deaths the shell failed to report or left in the job list, and the
+ * latency from a job's death (logged by myexit) to the shell's report
+ * of it.
+ *
+ * Stop storm: <jobs> background ./myspin jobs that are all stopped
+ * with SIGSTOP and continued <rounds> times, then killed. Reports how
+ * many of the stops went unreported within a second, and the latency
+ * from each SIGSTOP to the shell's report of it.
+ *
+ * Exits with 1 if any notification was lost.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#define MAXSTOPJOBS 16    /* the job list of tsh holds 16 jobs */
+#define REPORTWAIT 1000   /* ms to wait for the reports of a stop round */
+
+struct samples_t {          /* Latencies in ms */
+    double *v;
+    int n, max;
+};
+
+pid_t shell;                /* The shell */
+int tosh, fromsh;           /* Its stdin and stdout */
+char inbuf[1 << 16];        /* Shell output not yet split into lines */
+size_t inlen = 0;
+
+double nowms(void);
+void startshell(char **argv, char *log);
+void sendline(char *fmt, ...);
+char *readline(double *when, int timeout);
+char *waitfor(char *mark, double *when);
+void addsample(struct samples_t *s, double ms);
+static int dblcmp(const void *a, const void *b);
+void report(char *what, struct samples_t *s);
+int forkstorm(int njobs, int burst, char *log);
+int stopstorm(int njobs, int rounds);
+
+int main(int argc, char **argv)
+{
+    char *shellargv[] = { "./tsh", "-p", NULL };
+    char log[] = "/tmp/mystorm.XXXXXX";
+    int njobs = 2000, burst = 8, stopjobs = MAXSTOPJOBS, rounds = 50;
+    int c, lost;
+
+    while ((c = getopt(argc, argv, "s:n:b:k:r:")) != EOF) {
+        switch (c) {
+        case 's':
+            shellargv[0] = optarg;
+            break;
+        case 'n':
+            njobs = atoi(optarg);
+            break;
+        case 'b':
+            burst = atoi(optarg);
+            break;
+        case 'k':
+            stopjobs = atoi(optarg);
+            break;
+        case 'r':
+            rounds = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-s <shell>] [-n <jobs>] [-b <burst>] [-k <jobs>] [-r <rounds>]\n", argv[0]);
+            exit(2);
+        }
+    }
+    if (njobs < 1 || burst < 1 || burst > MAXSTOPJOBS || stopjobs < 1
+            || stopjobs > MAXSTOPJOBS || rounds < 1) {
+        fprintf(stderr, "%s: need 1 <= burst, -k jobs <= %d\n", argv[0], MAXSTOPJOBS);
+        exit(2);
+    }
+    signal(SIGPIPE, SIG_IGN);
+    if ((c = mkstemp(log)) < 0) {
+        perror("mkstemp");
+        exit(2);
+    }
+    close(c);
+
+    startshell(shellargv, log);
+    lost = forkstorm(njobs, burst, log);
+    lost += stopstorm(stopjobs, rounds);
+    sendline("quit");
+    waitpid(shell, NULL, 0);
+    unlink(log);
+    exit(lost > 0);
+}
+
+/* nowms - CLOCK_MONOTONIC time in ms */
+double nowms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/*
+ * startshell - Run the shell with its stdin and stdout on pipes, and
+ *    with myexit logging to log
+ */
+void startshell(char **argv, char *log)
+{
+    int in[2], out[2];
+
+    if (pipe2(in, O_CLOEXEC) < 0 || pipe2(out, O_CLOEXEC) < 0) {
+        perror("pipe");
+        exit(2);
+    }
+    if ((shell = fork()) == 0) {
+        dup2(in[0], STDIN_FILENO);
+        dup2(out[1], STDOUT_FILENO);
+        setenv("TSH_STORMLOG", log, 1);
+        execv(argv[0], argv);
+        fprintf(stderr, "mystorm: %s: %s\n", argv[0], strerror(errno));
+        _exit(2);
+    }
+    close(in[0]);
+    close(out[1]);
+    tosh = in[1];
+    fromsh = out[0];
+}
+
+/* sendline - Send a printf-style command line to the shell */
+void sendline(char *fmt, ...)
+{
+    char line[256];
+    va_list ap;
+    int n;
+
+    va_start(ap, fmt);
+    n = vsnprintf(line, sizeof(line) - 1, fmt, ap);
+    va_end(ap);
+    line[n++] = '\n';
+    if (write(tosh, line, n) != n) {
+        fprintf(stderr, "mystorm: the shell has gone away\n");
+        exit(2);
+    }
+}
+
+/*
+ * readline - Return the next line of shell output, without its \n,
+ *    and the time it was read in *when. Waits at most timeout ms (-1
+ *    for ever) and returns NULL if no line came in that time. Exits if
+ *    the shell has closed its output.
+ */
+char *readline(double *when, int timeout)
+{
+    static char line[sizeof(inbuf)];
+    struct pollfd pfd = { fromsh, POLLIN, 0 };
+    double end = nowms() + timeout;
+    char *nl;
+    ssize_t n;
+    size_t len;
+
+    while ((nl = memchr(inbuf, '\n', inlen)) == NULL) {
+        if (timeout >= 0 && (timeout = (int)(end - nowms())) < 0) {
+            return NULL;
+        }
+        if (poll(&pfd, 1, timeout) == 0) {
+            return NULL;
+        }
+        if ((n = read(fromsh, inbuf + inlen, sizeof(inbuf) - inlen)) <= 0) {
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "mystorm: the shell has gone away\n");
+            exit(2);
+        }
+        inlen += n;
+    }
+    *when = nowms();
+    len = nl - inbuf;
+    memcpy(line, inbuf, len);
+    line[len] = '\0';
+    inlen -= len + 1;
+    memmove(inbuf, nl + 1, inlen);
+    return line;
+}
+
+/*
+ * waitfor - Read shell output up to a line starting with mark (any
+ *    line if mark is NULL) and return it, with when it came in *when
+ */
+char *waitfor(char *mark, double *when)
+{
+    char *line;
+
+    while ((line = readline(when, -1)) != NULL) {
+        if (mark == NULL || !strncmp(line, mark, strlen(mark))) {
+            return line;
+        }
+    }
+    return NULL;
+}
+
+/* addsample - Record the latency ms in s */
+void addsample(struct samples_t *s, double ms)
+{
+    if (s->n == s->max) {
+        s->max = s->max ? 2 * s->max : 1024;
+        s->v = realloc(s->v, s->max * sizeof(double));
+    }
+    s->v[s->n++] = ms;
+}
+
+static int dblcmp(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* report - Print the percentiles of the latencies in s */
+void report(char *what, struct samples_t *s)
+{
+    if (s->n == 0) {
+        printf("  %s latency: no samples\n", what);
+        return;
+    }
+    qsort(s->v, s->n, sizeof(double), dblcmp);
+    printf("  %s latency ms: median %.3f, p99 %.3f, max %.3f\n", what,
+           s->v[s->n / 2], s->v[s->n * 99 / 100], s->v[s->n - 1]);
+}
+
+/*
+ * forkstorm - Run the fork storm and report on it. Returns the number
+ *    of notifications lost.
+ */
+int forkstorm(int njobs, int burst, char *log)
+{
+    static const int codes[] = { 0, 3, -SIGKILL, -SIGTERM };
+    struct samples_t lat = { NULL, 0, 0 };
+    double *death, t0, t1, when;
+    int i, pid, maxpid, signaled = 0, reported = 0, left = 0, rejected = 0;
+    pid_t writer;
+    long long ns;
+    char *line, *p;
+    FILE *fp;
+
+    /* A writer process feeds the shell, so neither side blocks on a full pipe */
+    t0 = nowms();
+    if ((writer = fork()) == 0) {
+        for (i = 0; i < njobs; i++) {
+            sendline("./myexit %d &", codes[i % 4]);
+            if (i % burst == burst - 1 || i == njobs - 1) {
+                sendline("wait");
+            }
+        }
+        sendline("echo storm-reaped");
+        sendline("jobs");
+        sendline("echo storm-listed");
+        _exit(0);
+    }
+    for (i = 0; i < njobs; i++) {
+        signaled += codes[i % 4] < 0;
+    }
+
+    /* Death times logged by myexit, indexed by pid */
+    if ((fp = fopen("/proc/sys/kernel/pid_max", "r")) == NULL || fscanf(fp, "%d", &maxpid) != 1) {
+        maxpid = 1 << 22;
+    }
+    if (fp != NULL) {
+        fclose(fp);
+    }
+    death = calloc(maxpid + 1, sizeof(double));
+
+    /* Reports come in until the mark; the death log is read as it grows */
+    fp = fopen(log, "r");
+    t1 = 0;
+    while (strcmp(line = waitfor(NULL, &when), "storm-listed")) {
+        if (!strcmp(line, "storm-reaped")) {
+            t1 = when;
+        } else if (t1 > 0) {
+            left++;                     /* a dead job still in the list */
+        } else if (strstr(line, "Tried to create too many jobs")) {
+            rejected++;
+        } else if ((p = strstr(line, ") terminated by signal")) != NULL) {
+            reported++;
+            while (p > line && p[-1] != '(') {
+                p--;
+            }
+            pid = atoi(p);
+            while (pid > 0 && pid <= maxpid && death[pid] == 0
+                   && fscanf(fp, "%d %lld", &i, &ns) == 2) {
+                if (i > 0 && i <= maxpid) {
+                    death[i] = ns / 1e6;
+                }
+            }
+            clearerr(fp);
+            if (pid > 0 && pid <= maxpid && death[pid] > 0) {
+                addsample(&lat, when - death[pid]);
+                death[pid] = 0;
+            }
+        }
+    }
+    fclose(fp);
+    free(death);
+    waitpid(writer, NULL, 0);
+
+    printf("fork storm: %d jobs in bursts of %d, %d of them killed by signals\n",
+           njobs, burst, signaled);
+    printf("  reaped in %.0f ms, %.0f jobs/s\n", t1 - t0, njobs * 1000 / (t1 - t0));
+    printf("  %d of %d signal deaths reported, %d lost, %d jobs left in the list, %d rejected\n",
+           reported, signaled, signaled - reported, left, rejected);
+    report("death-to-report", &lat);
+    free(lat.v);
+    return (signaled - reported) + left;
+}
+
+/*
+ * stopstorm - Run the stop storm and report on it. Returns the number
+ *    of notifications lost.
+ */
+int stopstorm(int njobs, int rounds)
+{
+    struct samples_t lat = { NULL, 0, 0 };
+    pid_t pids[MAXSTOPJOBS];
+    double sent[MAXSTOPJOBS], when;
+    int stopped[MAXSTOPJOBS];
+    int i, j, r, got, lost = 0, pid, jid;
+    char *line, *p;
+
+    for (i = 0; i < njobs; i++) {
+        sendline("./myspin 60 &");
+        line = waitfor("[", &when);
+        if (sscanf(line, "[%d] (%d)", &jid, &pids[i]) != 2) {
+            fprintf(stderr, "mystorm: unexpected output: %s\n", line);
+            exit(2);
+        }
+    }
+
+    for (r = 0; r < rounds; r++) {
+        for (i = 0; i < njobs; i++) {
+            stopped[i] = 0;
+            sent[i] = nowms();
+            kill(-pids[i], SIGSTOP);
+        }
+        for (got = 0; got < njobs && (line = readline(&when, REPORTWAIT)) != NULL; ) {
+            if ((p = strstr(line, ") stopped by signal")) == NULL) {
+                continue;
+            }
+            while (p > line && p[-1] != '(') {
+                p--;
+            }
+            pid = atoi(p);
+            for (j = 0; j < njobs; j++) {
+                if (pids[j] == pid && !stopped[j]) {
+                    stopped[j] = 1;
+                    addsample(&lat, when - sent[j]);
+                    got++;
+                }
+            }
+        }
+        lost += njobs - got;
+        for (i = 0; i < njobs; i++) {
+            kill(-pids[i], SIGCONT);
+        }
+    }
+
+    for (i = 0; i < njobs; i++) {
+        kill(-pids[i], SIGKILL);
+    }
+    sendline("wait");
+    sendline("echo storm-done");
+    waitfor("storm-done", &when);
+
+    printf("stop storm: %d jobs stopped and continued %d times\n", njobs, rounds);
+    printf("  %d of %d stops reported, %d lost\n", njobs * rounds - lost, njobs * rounds, lost);
+    report("stop-to-report", &lat);
+    free(lat.v);
+    return lost;
+}
@@ -0,0 +1,645 @@
+/*
+ * tdriver.c - A native trace driver that replays traces in parallel
+ *
+ * usage: tdriver [-hov] [-j <jobs>] [-n <copies>] [-s <shell>]
+ *                [-r <refshell>] [-a <args>] <trace>...
+ *
+ * Replays trace files in the format of sdriver.pl, the same way it
+ * does: comment lines are echoed, blank lines ignored, a line holding
+ * TSTP, INT, QUIT, KILL, CLOSE, WAIT or SLEEP <secs> is a driver
+ * command and every other line is sent to the shell. Unlike
+ * sdriver.pl, SLEEP takes fractions of a second, trailing CRs are
+ * ignored, and <copies> copies of every trace run at once, up to
+ * <jobs> shells at a time. The shell's output is read while the trace
+ * runs, so a chatty shell never blocks.
+ *
+ * With -r each trace also runs against <refshell>, and the output of
+ * every copy is compared with the reference once PIDs and ps(1) lines
+ * are masked out. Without it, or with -o, the output of the first copy
+ * is printed as sdriver.pl would. Either way the latency of each shell
+ * is reported, as the time from sending a /bin/echo line of the trace
+ * to its text showing up in the output. Only an echo sent first after
+ * the start, a SLEEP or a signal is timed, so it does not queue behind
+ * earlier commands, and only until the next SLEEP ends or signal is
+ * sent, so output of jobs that shows up later is never charged to it.
+ * Exits with 1 if any output differed from the reference.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#define MAXARGS  32   /* max shell arguments */
+#define MAXRUNS 4096  /* max shells per invocation */
+#define WAITPOLL  5   /* ms between checks on a shell being waited for */
+
+struct buf_t {              /* A growable byte buffer */
+    char *data;
+    size_t len, max;
+};
+
+struct trace_t {            /* A trace file, split into lines */
+    char *name;
+    char **lines;           /* without their \n or \r\n */
+    int n;
+};
+
+struct run_t {              /* One shell replaying one copy of a trace */
+    struct trace_t *trace;
+    int ref;                /* 0 for the shell under test, 1 for the reference */
+    int copy;               /* copy number of the trace */
+    pid_t pid;              /* the shell, 0 before it starts and once done */
+    int wfd, rfd;           /* its stdin and stdout, -1 once closed */
+    int next;               /* next trace line */
+    double wake;            /* time it sleeps until, 0 if awake */
+    int waiting;            /* WAIT: blocked until the shell is reaped */
+    int reaped;             /* the shell has been reaped */
+    int idle;               /* nothing sent since the start, a SLEEP or a signal */
+    double sent;            /* when the awaited echo went out, 0 if none */
+    char *await;            /* the text it prints ... */
+    size_t awaitlen;
+    size_t seen;            /* ... to be found in out past this */
+    struct buf_t comments;  /* echoed comment lines */
+    struct buf_t out;       /* output of the shell */
+};
+
+struct samples_t {          /* Command latencies of one shell, in ms */
+    double *v;
+    int n, max;
+};
+
+char *shells[2] = { "./tsh", NULL }; /* Shell under test and reference */
+char *shellargv[2][MAXARGS + 2];    /* Their argv */
+struct run_t runs[MAXRUNS];
+int nruns = 0;
+struct samples_t samples[2];
+int verbose = 0;
+
+void usage(char *prog);
+double now(void);
+void append(struct buf_t *b, const char *s, size_t n);
+void readtrace(struct trace_t *t, char *name);
+void splitargs(char **argv, char *shell, char *args);
+void startrun(struct run_t *r);
+void steprun(struct run_t *r);
+void awaitecho(struct run_t *r, char *arg);
+void readrun(struct run_t *r);
+int finished(struct run_t *r);
+void addsample(int ref, double ms);
+void normalize(struct buf_t *dst, struct buf_t *src);
+int compare(struct run_t *t, struct run_t *r);
+static int dblcmp(const void *a, const void *b);
+void report(int ref);
+
+int main(int argc, char **argv)
+{
+    struct trace_t *traces;
+    struct pollfd fds[MAXRUNS];
+    struct run_t *polled[MAXRUNS];      /* Run of each fds entry */
+    struct run_t *r;
+    char *args = "-p";                  /* Shell arguments */
+    int jobs = 16, copies = 1, print = 0, bad = 0;
+    int i, j, c, ntraces, nfds, started = 0, active = 0, done = 0, timeout;
+    double t0, wake;
+
+    while ((c = getopt(argc, argv, "hovj:n:s:r:a:")) != EOF) {
+        switch (c) {
+        case 'o':                       /* print the output of the first copies */
+            print = 1;
+            break;
+        case 'v':
+            verbose = 1;
+            break;
+        case 'j':
+            jobs = atoi(optarg);
+            break;
+        case 'n':
+            copies = atoi(optarg);
+            break;
+        case 's':
+            shells[0] = optarg;
+            break;
+        case 'r':
+            shells[1] = optarg;
+            break;
+        case 'a':
+            args = optarg;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    ntraces = argc - optind;
+    if (ntraces == 0 || jobs < 1 || copies < 1
+            || ntraces * copies * (1 + (shells[1] != NULL)) > MAXRUNS) {
+        usage(argv[0]);
+    }
+    if (shells[1] == NULL) {
+        print = 1;
+    }
+    signal(SIGPIPE, SIG_IGN);           /* a killed shell must not kill us */
+
+    /* Every copy of every trace, interleaved with its reference runs */
+    traces = calloc(ntraces, sizeof(struct trace_t));
+    for (i = 0; i < ntraces; i++) {
+        readtrace(&traces[i], argv[optind + i]);
+    }
+    for (i = 0; i < 2 && shells[i] != NULL; i++) {
+        splitargs(shellargv[i], shells[i], args);
+    }
+    for (c = 0; c < copies; c++) {
+        for (i = 0; i < ntraces; i++) {
+            for (j = 0; j < 2 && shells[j] != NULL; j++) {
+                r = &runs[nruns++];
+                r->trace = &traces[i];
+                r->ref = j;
+                r->copy = c;
+                r->wfd = r->rfd = -1;
+            }
+        }
+    }
+
+    /* Event loop: step every live run, then sleep until output or the next wake */
+    t0 = now();
+    while (done < nruns) {
+        while (active < jobs && started < nruns) {
+            startrun(&runs[started++]);
+            active++;
+        }
+        wake = 0;
+        nfds = 0;
+        timeout = -1;
+        for (i = 0; i < started; i++) {
+            r = &runs[i];
+            if (r->pid == 0) {
+                continue;               /* already finished */
+            }
+            steprun(r);
+            if (finished(r)) {
+                r->pid = 0;
+                active--;
+                done++;
+                continue;
+            }
+            if (r->rfd >= 0) {
+                fds[nfds].fd = r->rfd;
+                fds[nfds].events = POLLIN;
+                polled[nfds++] = r;
+            }
+            if (r->wake > 0 && (wake == 0 || r->wake < wake)) {
+                wake = r->wake;
+            }
+            if (r->waiting || (r->rfd < 0 && !r->reaped)) {
+                timeout = WAITPOLL;
+            }
+        }
+        if (done == nruns) {
+            break;
+        }
+        if (active < jobs && started < nruns) {
+            continue;                   /* a slot has just been freed */
+        }
+        if (wake > 0) {
+            i = (int)((wake - now()) * 1000) + 1;
+            if (timeout < 0 || i < timeout) {
+                timeout = (i > 0) ? i : 0;
+            }
+        }
+        if (poll(fds, nfds, timeout) < 0 && errno != EINTR) {
+            perror("poll");
+            exit(2);
+        }
+        for (i = 0; i < nfds; i++) {
+            if (fds[i].revents) {
+                readrun(polled[i]);
+            }
+        }
+    }
+
+    /* Results in trace order */
+    for (i = 0; i < nruns; i++) {
+        r = &runs[i];
+        if (r->ref) {
+            continue;
+        }
+        if (print && r->copy == 0) {
+            fwrite(r->comments.data, 1, r->comments.len, stdout);
+            fwrite(r->out.data, 1, r->out.len, stdout);
+        }
+        if (shells[1] != NULL && compare(r, r + 1) < 0) {
+            bad = 1;
+        }
+    }
+    if (shells[1] != NULL && !bad) {
+        printf("%d runs of %d traces match %s\n", nruns / 2, ntraces, shells[1]);
+    }
+    printf("%d shells in %.0f ms, %d at a time\n", nruns, (now() - t0) * 1000, jobs);
+    report(0);
+    if (shells[1] != NULL) {
+        report(1);
+    }
+    exit(bad);
+}
+
+/*
+ * usage - print a help message and terminate
+ */
+void usage(char *prog)
+{
+    fprintf(stderr, "Usage: %s [-hov] [-j <jobs>] [-n <copies>] [-s <shell>] [-r <refshell>] [-a <args>] <trace>...\n", prog);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -h            Print this message\n");
+    fprintf(stderr, "  -o            Print the output of the shell, as sdriver.pl does\n");
+    fprintf(stderr, "  -v            Say what the driver does\n");
+    fprintf(stderr, "  -j <jobs>     Shells running at once (default 16)\n");
+    fprintf(stderr, "  -n <copies>   Copies of each trace to run (default 1)\n");
+    fprintf(stderr, "  -s <shell>    Shell program to test (default ./tsh)\n");
+    fprintf(stderr, "  -r <refshell> Reference shell to compare the output with\n");
+    fprintf(stderr, "  -a <args>     Shell arguments (default -p)\n");
+    exit(2);
+}
+
+/* now - CLOCK_MONOTONIC time in seconds */
+double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* append - Append the n bytes at s to b */
+void append(struct buf_t *b, const char *s, size_t n)
+{
+    if (b->len + n + 1 > b->max) {
+        b->max = 2 * (b->len + n + 1);
+        if ((b->data = realloc(b->data, b->max)) == NULL) {
+            perror("realloc");
+            exit(2);
+        }
+    }
+    memcpy(b->data + b->len, s, n);
+    b->len += n;
+    b->data[b->len] = '\0';
+}
+
+/* readtrace - Read the trace file name into t, dropping line ends */
+void readtrace(struct trace_t *t, char *name)
+{
+    FILE *fp;
+    char *line = NULL;
+    size_t cap = 0;
+    ssize_t n;
+    int max = 0;
+
+    if ((fp = fopen(name, "r")) == NULL) {
+        fprintf(stderr, "tdriver: ERROR: Couldn't open input file %s: %s\n", name, strerror(errno));
+        exit(2);
+    }
+    t->name = name;
+    while ((n = getline(&line, &cap, fp)) >= 0) {
+        while (n > 0 && (line[n - 1] == '\n' || line[n - 1] == '\r')) {
+            line[--n] = '\0';
+        }
+        if (t->n == max) {
+            max = max ? 2 * max : 64;
+            t->lines = realloc(t->lines, max * sizeof(char *));
+        }
+        t->lines[t->n++] = strdup(line);
+    }
+    free(line);
+    fclose(fp);
+}
+
+/* splitargs - Build the argv of shell from the words of args */
+void splitargs(char **argv, char *shell, char *args)
+{
+    char *copy = strdup(args), *word;
+    int n = 0;
+
+    argv[n++] = shell;
+    for (word = strtok(copy, " \t"); word != NULL && n <= MAXARGS; word = strtok(NULL, " \t")) {
+        argv[n++] = word;
+    }
+    argv[n] = NULL;
+}
+
+/*
+ * startrun - Start the shell of r with its stdin and stdout on pipes.
+ *    Every descriptor is close-on-exec, so no shell holds another's
+ *    pipes open.
+ */
+void startrun(struct run_t *r)
+{
+    int in[2], out[2];
+
+    if (pipe2(in, O_CLOEXEC) < 0 || pipe2(out, O_CLOEXEC) < 0) {
+        perror("pipe");
+        exit(2);
+    }
+    if ((r->pid = fork()) < 0) {
+        perror("fork");
+        exit(2);
+    }
+    if (r->pid == 0) {
+        dup2(in[0], STDIN_FILENO);
+        dup2(out[1], STDOUT_FILENO);
+        execv(shells[r->ref], shellargv[r->ref]);
+        fprintf(stderr, "tdriver: ERROR: %s: %s\n", shells[r->ref], strerror(errno));
+        _exit(2);
+    }
+    close(in[0]);
+    close(out[1]);
+    r->wfd = in[1];
+    r->rfd = out[0];
+    fcntl(r->rfd, F_SETFL, O_NONBLOCK);
+    r->idle = 1;
+    if (verbose) {
+        printf("tdriver: %s copy %d: started %s as %d\n", r->trace->name, r->copy,
+               shells[r->ref], (int)r->pid);
+    }
+}
+
+/*
+ * steprun - Carry out the trace lines of r until it has to sleep or
+ *    wait for its shell, or has none left. Keywords are matched
+ *    anywhere in the line, in the order sdriver.pl tries them.
+ */
+void steprun(struct run_t *r)
+{
+    char *line, *p;
+    int sig;
+
+    while (1) {
+        if (r->wake > 0) {
+            if (now() < r->wake) {
+                return;
+            }
+            r->wake = 0;
+            r->sent = 0;                /* the echo had the whole SLEEP to show up */
+            r->idle = 1;
+        }
+        if (r->waiting || r->next == r->trace->n) {
+            if (!r->reaped && waitpid(r->pid, NULL, WNOHANG) == r->pid) {
+                r->reaped = 1;
+            }
+            if (r->waiting && !r->reaped) {
+                return;
+            }
+            r->waiting = 0;
+        }
+        if (r->next == r->trace->n) {
+            if (r->wfd >= 0) {
+                close(r->wfd);          /* EOF, the shell exits */
+                r->wfd = -1;
+            }
+            return;
+        }
+
+        line = r->trace->lines[r->next++];
+        sig = 0;
+        if (line[0] == '#') {
+            append(&r->comments, line, strlen(line));
+            append(&r->comments, "\n", 1);
+            continue;
+        }
+        for (p = line; isspace((unsigned char)*p); p++) {
+            ;
+        }
+        if (*p == '\0') {
+            continue;
+        }
+        if (strstr(line, "TSTP")) {
+            sig = SIGTSTP;
+        } else if (strstr(line, "INT")) {
+            sig = SIGINT;
+        } else if (strstr(line, "QUIT")) {
+            sig = SIGQUIT;
+        } else if (strstr(line, "KILL")) {
+            sig = SIGKILL;
+        } else if (strstr(line, "CLOSE")) {
+            if (r->wfd >= 0) {
+                close(r->wfd);
+                r->wfd = -1;
+            }
+            continue;
+        } else if (strstr(line, "WAIT")) {
+            r->waiting = 1;
+            continue;
+        } else if ((p = strstr(line, "SLEEP ")) != NULL && isdigit((unsigned char)p[6])) {
+            r->wake = now() + strtod(p + 6, NULL);
+            continue;
+        }
+        if (sig != 0) {
+            r->sent = 0;
+            r->idle = 1;
+            if (verbose) {
+                printf("tdriver: %s copy %d: sending signal %d to %d\n", r->trace->name,
+                       r->copy, sig, (int)r->pid);
+            }
+            if (!r->reaped) {
+                kill(r->pid, sig);
+            }
+            continue;
+        }
+        if (r->wfd >= 0) {
+            if (r->idle && !strncmp(line, "/bin/echo ", 10)) {
+                awaitecho(r, line + 10);
+            }
+            r->idle = 0;
+            if (write(r->wfd, line, strlen(line)) < 0 || write(r->wfd, "\n", 1) < 0) {
+                r->sent = 0;            /* the shell is gone */
+            }
+        }
+    }
+}
+
+/*
+ * awaitecho - Start timing the echo line of r with arguments arg. It
+ *    prints them without their quotes; with -e only the text before
+ *    the first escape is looked for.
+ */
+void awaitecho(struct run_t *r, char *arg)
+{
+    size_t len;
+
+    if (!strncmp(arg, "-e ", 3)) {
+        arg += 3;
+    }
+    len = strlen(arg);
+    if (len >= 2 && arg[0] == '\'' && arg[len - 1] == '\'') {
+        arg++;
+        len -= 2;
+    }
+    if (memchr(arg, '\\', len) != NULL) {
+        len = (char *)memchr(arg, '\\', len) - arg;
+    }
+    r->sent = (len > 0) ? now() : 0;
+    r->await = arg;
+    r->awaitlen = len;
+    r->seen = r->out.len;
+}
+
+/*
+ * readrun - Read what the shell of r has written. The text of the
+ *    awaited echo showing up gives a latency sample.
+ */
+void readrun(struct run_t *r)
+{
+    char buf[65536];
+    ssize_t n;
+
+    while ((n = read(r->rfd, buf, sizeof(buf))) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN) {
+                return;
+            }
+            break;
+        }
+        append(&r->out, buf, n);
+        if (r->sent > 0 && memmem(r->out.data + r->seen, r->out.len - r->seen,
+                                  r->await, r->awaitlen) != NULL) {
+            addsample(r->ref, (now() - r->sent) * 1000);
+            r->sent = 0;
+        }
+    }
+    close(r->rfd);
+    r->rfd = -1;
+}
+
+/*
+ * finished - Is r done? Its trace is through, its output read to EOF
+ *    and its shell reaped.
+ */
+int finished(struct run_t *r)
+{
+    if (r->next < r->trace->n || r->wake > 0 || r->rfd >= 0) {
+        return 0;
+    }
+    if (!r->reaped && waitpid(r->pid, NULL, WNOHANG) == r->pid) {
+        r->reaped = 1;
+    }
+    return r->reaped;
+}
+
+/* addsample - Record a command latency of ms for shell ref */
+void addsample(int ref, double ms)
+{
+    struct samples_t *s = &samples[ref];
+
+    if (s->n == s->max) {
+        s->max = s->max ? 2 * s->max : 1024;
+        s->v = realloc(s->v, s->max * sizeof(double));
+    }
+    s->v[s->n++] = ms;
+}
+
+/*
+ * normalize - Append src to dst with every "(digits)" replaced by
+ *    "(PID)" and the process lines of ps(1) left out
+ */
+void normalize(struct buf_t *dst, struct buf_t *src)
+{
+    char *line = src->data, *end, *p, *q;
+
+    if (line == NULL) {
+        return;
+    }
+    for (; *line; line = end) {
+        if ((end = strchr(line, '\n')) == NULL) {
+            end = line + strlen(line);
+        } else {
+            end++;
+        }
+        for (p = line; *p == ' '; p++) {
+            ;
+        }
+        if (isdigit((unsigned char)*p)) {
+            for (; isdigit((unsigned char)*p); p++) {
+                ;
+            }
+            if (*p == ' ') {
+                continue;               /* "  PID TTY ..." */
+            }
+        }
+        for (p = line; p < end; p = q) {
+            q = p + 1;
+            if (*p == '(' && isdigit((unsigned char)*q)) {
+                while (isdigit((unsigned char)*q)) {
+                    q++;
+                }
+                if (*q == ')') {
+                    append(dst, "(PID)", 5);
+                    q++;
+                    continue;
+                }
+                q = p + 1;
+            }
+            append(dst, p, 1);
+        }
+    }
+}
+
+/*
+ * compare - Compare the output of the run t with its reference run r,
+ *    reporting the first line that differs. Returns -1 if one does.
+ */
+int compare(struct run_t *t, struct run_t *r)
+{
+    struct buf_t a = { NULL, 0, 0 }, b = { NULL, 0, 0 };
+    char *p, *q, *pe, *qe;
+    int line = 1, ret = 0;
+
+    normalize(&a, &t->out);
+    normalize(&b, &r->out);
+    append(&a, "", 0);
+    append(&b, "", 0);
+    for (p = a.data, q = b.data; *p || *q; p = pe + (*pe != '\0'), q = qe + (*qe != '\0'), line++) {
+        pe = p + strcspn(p, "\n");
+        qe = q + strcspn(q, "\n");
+        if (pe - p != qe - q || strncmp(p, q, pe - p)) {
+            printf("%s copy %d: line %d differs\n", t->trace->name, t->copy, line);
+            printf("  %s: %.*s\n", shells[0], (int)(pe - p), p);
+            printf("  %s: %.*s\n", shells[1], (int)(qe - q), q);
+            ret = -1;
+            break;
+        }
+    }
+    free(a.data);
+    free(b.data);
+    return ret;
+}
+
+static int dblcmp(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* report - Print the latency percentiles of shell ref */
+void report(int ref)
+{
+    struct samples_t *s = &samples[ref];
+
+    if (s->n == 0) {
+        printf("%s: no command latencies\n", shells[ref]);
+        return;
+    }
+    qsort(s->v, s->n, sizeof(double), dblcmp);
+    printf("%s: %d commands, latency ms: median %.3f, p90 %.3f, p99 %.3f, max %.3f\n",
+           shells[ref], s->n, s->v[s->n / 2], s->v[s->n * 90 / 100],
+           s->v[s->n * 99 / 100], s->v[s->n - 1]);
+}
@@ -1,896 +1,3953 @@
-/*
- * tsh - A tiny shell program with job control
- *
- * === User information ===
- * Group: Pending-group-name
- * ===
- * User 1: ernir17
- * SSN: 180996-4279
- * ===
- * User 2: egilltor17
- * SSN: 250697-2529
- * ===
- * User 3: hallgrimura17
- * SSN: 040396-2929
- * === End User Information ===
- */
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <unistd.h>
-#include <string.h>
-#include <ctype.h>
-#include <signal.h>
-#include <sys/types.h>
-#include <sys/wait.h>
-#include <errno.h>
-
-/* Misc manifest constants */
-#define MAXLINE    1024   /* max line size */
-#define MAXARGS     128   /* max args on a command line */
-#define MAXJOBS      16   /* max jobs at any point in time */
-#define MAXJID    1<<16   /* max job ID */
-
-/* Job states */
-#define UNDEF 0 /* undefined */
-#define FG 1    /* running in foreground */
-#define BG 2    /* running in background */
-#define ST 3    /* stopped */
-
-/*
- * Jobs states: FG (foreground), BG (background), ST (stopped)
- * Job state transitions and enabling actions:
- *     FG -> ST  : ctrl-z
- *     ST -> FG  : fg command
- *     ST -> BG  : bg command
- *     BG -> FG  : fg command
- * At most 1 job can be in the FG state.
- */
-
-/* Global variables */
-extern char **environ;      /* defined in libc */
-char prompt[] = "tsh> ";    /* command line prompt (DO NOT CHANGE) */
-int verbose = 0;            /* if true, print additional output */
-int nextjid = 1;            /* next job ID to allocate */
-char sbuf[MAXLINE];         /* for composing sprintf messages */
-
-char intstring[10];
-
-struct job_t {              /* The job struct */
-    pid_t pid;              /* job PID */
-    int jid;                /* job ID [1, 2, ...] */
-    int state;              /* UNDEF, BG, FG, or ST */
-    char cmdline[MAXLINE];  /* command line */
-};
-struct job_t jobs[MAXJOBS]; /* The job list */
-/* End global variables */
-
-
-/* Function prototypes */
-pid_t Fork(void);
-int Kill(pid_t pid, int sig);
-int Execve(const char *filename, char *const argv[], char *const envp[]);
-int Sigemptyset(sigset_t *sig);
-int Sigaddset(sigset_t *sig, int signum);
-int Sigprocmask(int how, const sigset_t *restrict set, sigset_t *restrict oset);
-int Setpgid(pid_t pid, pid_t pgid);
-ssize_t Sio_puts(char s[]);
-ssize_t Sio_putl(long v);
-
-/* Functions extracted from csapp.c */
-ssize_t sio_puts(char s[]);
-static size_t sio_strlen(char s[]);
-void sio_error(char s[]);
-ssize_t sio_putl(long v);
-static void sio_ltoa(long v, char s[], int b);
-
-/* Here are the functions that you will implement */
-void eval(char *cmdline);
-int builtin_cmd(char **argv);
-void do_bgfg(char **argv);
-void waitfg(pid_t pid);
-
-void sigchld_handler(int sig);
-void sigtstp_handler(int sig);
-void sigint_handler(int sig);
-void std_sig_handler(int sig);
-
-/* Here are helper routines that we've provided for you */
-int parseline(const char *cmdline, char **argv);
-void sigquit_handler(int sig);
-
-void clearjob(struct job_t *job);
-void initjobs(struct job_t *jobs);
-int maxjid(struct job_t *jobs);
-int addjob(struct job_t *jobs, pid_t pid, int state, char *cmdline);
-int deletejob(struct job_t *jobs, pid_t pid);
-pid_t fgpid(struct job_t *jobs);
-struct job_t *getjobpid(struct job_t *jobs, pid_t pid);
-struct job_t *getjobjid(struct job_t *jobs, int jid);
-int pid2jid(pid_t pid);
-void listjobs(struct job_t *jobs);
-
-void usage(void);
-void unix_error(char *msg);
-void app_error(char *msg);
-typedef void handler_t(int);
-handler_t *Signal(int signum, handler_t *handler);
-
-/*
- * main - The shell's main routine
- */
-int main(int argc, char **argv)
-{
-    char c;
-    char cmdline[MAXLINE];
-    int emit_prompt = 1; /* emit prompt (default) */
-
-    /* Redirect stderr to stdout (so that driver will get all output
-     * on the pipe connected to stdout) */
-    dup2(1, 2);
-
-    /* Parse the command line */
-    while ((c = getopt(argc, argv, "hvp")) != EOF) {
-        switch (c) {
-        case 'h':             /* print help message */
-            usage();
-            break;
-        case 'v':             /* emit additional diagnostic info */
-            verbose = 1;
-            break;
-        case 'p':             /* don't print a prompt */
-            emit_prompt = 0;  /* handy for automatic testing */
-            break;
-        default:
-            usage();
-        }
-    }
-
-    /* Install the signal handlers */
-
-    /* These are the ones you will need to implement */
-    Signal(SIGINT,  sigint_handler);   /* ctrl-c */
-    Signal(SIGTSTP, sigtstp_handler);  /* ctrl-z */
-    Signal(SIGCHLD, sigchld_handler);  /* Terminated or stopped child */
-
-    /* This one provides a clean way to kill the shell */
-    Signal(SIGQUIT, sigquit_handler);
-
-    /* Initialize the job list */
-    initjobs(jobs);
-
-    /* Execute the shell's read/eval loop */
-    while (1) {
-        /* Read command line */
-        if (emit_prompt) {
-            printf("%s", prompt);
-            fflush(stdout);
-        }
-        if ((fgets(cmdline, MAXLINE, stdin) == NULL) && ferror(stdin)) {
-            app_error("fgets error");
-        }
-        if (feof(stdin)) { /* End of file (ctrl-d) */
-            fflush(stdout);
-            exit(0);
-        }
-
-        /* Evaluate the command line */
-        eval(cmdline);
-        fflush(stdout);
-        fflush(stdout);
-    }
-
-    exit(0); /* control never reaches here */
-}
-
-/*
- * HELPER FUNCTIONS 
- * Safe IO functions taken from csapp.c for use in signal handlers
- */
-ssize_t sio_puts(char s[]) /* Put string */ {
-    return write(STDOUT_FILENO, s, sio_strlen(s)); //line:csapp:siostrlen
-}
-
-static size_t sio_strlen(char s[])
-{
-    int i = 0;
-
-    while (s[i] != '\0') {
-        ++i;
-    }
-    return i;
-}
-
-void sio_error(char s[]) /* Put error message and exit */
-{
-    sio_puts(s);
-    _exit(1);                                      //line:csapp:sioexit
-}
-
-/* sio_reverse - Reverse a string (from K&R) */
-static void sio_reverse(char s[])
-{
-    int c, i, j;
-
-    for (i = 0, j = strlen(s)-1; i < j; i++, j--) {
-        c = s[i];
-        s[i] = s[j];
-        s[j] = c;
-    }
-}
-
-/* Put long */
-ssize_t sio_putl(long v) 
-{
-    char s[128];
-    
-    sio_ltoa(v, s, 10); /* Based on K&R itoa() */  //line:csapp:sioltoa
-    return sio_puts(s);
-}
-
-/* sio_ltoa - Convert long to base b string (from K&R) */
-static void sio_ltoa(long v, char s[], int b) 
-{
-    int c, i = 0;
-    int neg = v < 0;
-
-    if (neg)
-	v = -v;
-
-    do {  
-        s[i++] = ((c = (v % b)) < 10)  ?  c + '0' : c - 10 + 'a';
-    } while ((v /= b) > 0);
-
-    if (neg)
-	s[i++] = '-';
-
-    s[i] = '\0';
-    sio_reverse(s);
-}
-/*
- *  END OF HELPER FUNCTIONS
- */
-
-
-/*
- *  WRAPPER FUNCTIONS
- */
-
-/* Wrapper for system function fork() */
-pid_t Fork(void)
-{
-	pid_t pid;                      /* Process id */
-	if ((pid = fork()) < 0) {
-		unix_error("fork error");
-    }
-    return pid;
-}
-
-/* Wrapper for system function kill() */
-int Kill(pid_t pid, int sig)
-{
-	int result;                     /* return form kill */
-	if ((result = kill(pid, sig)) < 0) {
-		unix_error("kill error");
-    }
-    return result;
-}
-
-/* Wrapper for system function execve() */
-int Execve(const char *filename, char *const argv[], char *const envp[])
-{
-	int result;
-	if ((result = execve(filename, argv, envp)) < 0) {
-		unix_error("execve error");
-    }
-    return result;
-}
-
-/* Wrapper for system function sigemptyset() */
-int Sigemptyset(sigset_t *sig)
-{
-	int result;
-	if ((result = sigemptyset(sig)) < 0) {
-		unix_error("sigemptyset error");
-    }
-    return result;
-}
-
-/* Wrapper for system function sigaddset() */
-int Sigaddset(sigset_t *sig, int signum)
-{
-	int result;
-	if ((result = sigaddset(sig, signum)) < 0) {
-		unix_error("sigaddset error");
-    }
-    return result;
-}
-
-/* Wrapper for system function sigprocmask() */
-int Sigprocmask(int how, const sigset_t *restrict set, sigset_t *restrict oset)
-{
-	int result;
-	if ((result = sigprocmask(how, set, oset)) < 0) {
-		unix_error("sigprocmask error");
-    }
-    return result;
-}
-
-/* Wrapper for system function setpgid() */
-int Setpgid(pid_t pid, pid_t pgid)
-{
-	int result;
-	if ((result = setpgid(pid, pgid)) < 0) {
-		unix_error("setpgid error");
-    }
-    return result;
-}
-
-/* Wrapper for csapp function sio_puts() */
-ssize_t Sio_puts(char s[])
-{
-    ssize_t n;
-    if ((n = sio_puts(s)) < 0) {
-	    sio_error("Sio_puts error");
-    }
-    return n;
-}
-
-/* Wrapper for csapp function sio_putl() */
-ssize_t Sio_putl(long v)
-{
-    ssize_t n;
-    if ((n = sio_putl(v)) < 0)
-	sio_error("Sio_putl error");
-    return n;
-}
-/*
- *  END OF WRAPPER FUNCTIONS
- */
-
-/*
- * eval - Evaluate the command line that the user has just typed in
- *
- * If the user has requested a built-in command (quit, jobs, bg or fg)
- * then execute it immediately. Otherwise, fork a child process and
- * run the job in the context of the child. If the job is running in
- * the foreground, wait for it to terminate and then return.  Note:
- * each child process must have a unique process group ID so that our
- * background children don't receive SIGINT (SIGTSTP) from the kernel
- * when we type ctrl-c (ctrl-z) at the keyboard.
- */
-void eval(char *cmdline)
-{
-	char *argv[MAXARGS];		/* Argument list execve() */
-	char buf[MAXLINE];			/* Holds modified command line */
-	int bg;						/* Should the job run in bg or fg? */
-	pid_t pid;					/* Process id */
-    sigset_t mask, prev_one;    /* Mask for SIGCHLD and Mask backup */
-    
-	
-	strcpy(buf, cmdline);
-	bg = parseline(buf, argv);
-	if (argv[0] == NULL) {
-		return;					/* Ignore empty lines */
-	}
-
-	if (!builtin_cmd(argv)) {
-        Sigemptyset(&mask);
-        Sigaddset(&mask, SIGCHLD);
-        Sigprocmask(SIG_BLOCK, &mask, &prev_one);           /* Block SIGCHLD */
-		/* Child runs user job */ 
-        if ((pid = Fork()) == 0) {                          /* Child */                          
-            Setpgid(0, 0);                                  /* Get new group for child process */
-            Sigprocmask(SIG_SETMASK, &prev_one, NULL);      /* Unblock SIGCHLD */
-			if (execve(argv[0], argv, environ) < 0) {       /* Execute the command in the child process */
-                printf("%s: Command not found\n", argv[0]);
-			    exit(0);	
-			}
-        /* Parent waits for child */
-		} else {                                            /* Parent */
-            addjob(jobs, pid,(2 - !bg), cmdline);           /* Add child to joblist */
-            Sigprocmask(SIG_SETMASK, &prev_one, NULL);      /* Unblock Parent */
-            if (!bg) {
-                waitfg(pid);                                /* Parent waits for foreground job to terminate */
-            } 
-            else {
-                printf("[%d] (%d) %s", pid2jid(pid), pid, cmdline); /* Alert user of background process */
-            }
-        }
-	}
-	return;
-}
-
-
-/*
- * parseline - Parse the command line and build the argv array.
- *
- * Characters enclosed in single quotes are treated as a single
- * argument.  Return true if the user has requested a BG job, false if
- * the user has requested a FG job.
- */
-int parseline(const char *cmdline, char **argv)
-{
-    static char array[MAXLINE]; /* holds local copy of command line */
-    char *buf = array;          /* ptr that traverses command line */
-    char *delim;                /* points to first space delimiter */
-    int argc;                   /* number of args */
-    int bg;                     /* background job? */
-
-    strcpy(buf, cmdline);
-    buf[strlen(buf)-1] = ' ';       /* replace trailing '\n' with space */
-    while (*buf && (*buf == ' ')) { /* ignore leading spaces */
-        buf++;
-    }
-
-    /* Build the argv list */
-    argc = 0;
-    if (*buf == '\'') {
-        buf++;
-        delim = strchr(buf, '\'');
-    }
-    else {
-        delim = strchr(buf, ' ');
-    }
-
-    while (delim) {
-        argv[argc++] = buf;
-        *delim = '\0';
-        buf = delim + 1;
-        while (*buf && (*buf == ' ')) { /* ignore spaces */
-            buf++;
-        }
-
-        if (*buf == '\'') {
-            buf++;
-            delim = strchr(buf, '\'');
-        }
-        else {
-            delim = strchr(buf, ' ');
-        }
-    }
-    argv[argc] = NULL;
-
-    if (argc == 0) { /* ignore blank line */
-        return 1;
-    }
-
-    /* should the job run in the background? */
-    if ((bg = (*argv[argc-1] == '&')) != 0) {
-        argv[--argc] = NULL;
-    }
-    return bg;
-}
-
-/*
- * builtin_cmd - If the user has typed a built-in command then execute
- *    it immediately.
- */
-int builtin_cmd(char **argv)
-{
-	if (!strcmp(argv[0], "quit")) { 	/* quit command */
-        exit(0);
-    }
-    if (!strcmp(argv[0], "jobs")) {     /* jobs command */
-        listjobs(jobs);
-        return 1;
-    }
-	if (!strcmp(argv[0], "fg") || !strcmp(argv[0], "bg")) { /* fg or bg command */
-        do_bgfg(argv);
-        return 1;
-    }
-    if (!strcmp(argv[0], "&")) {		/* Ignore singleton & */
-        return 1;
-    }
-    return 0;							/* Not a builtin command */
-}
-
-/*
- * do_bgfg - Execute the builtin bg and fg commands
- */
-void do_bgfg(char **argv)
-{
-    struct job_t *job;                  /* Job list */
-    int jid;                            /* Job id */
-    pid_t pid;                          /* Process id of child or null */
-
-    /* checks if function has second argument */
-    if (argv[1] == NULL) {
-        printf("%s command requires PID or %%jobid argument\n", argv[0]);
-        return;
-    }
-
-    /*
-     * the following three if statements read the first
-     * character from the second argument of argv to see
-     * whether the second argument is a jid or a pid or neither
-     */ 
-    if (argv[1][0] == '%') { /* jid */
-        /*
-         * pointer starts on the second character of the second argument (ex. %123)
-         * since the '%' symbol is only used to differentiate between pid and jid
-         * and not a part of the jid itself 
-         */
-        jid = atoi(argv[1] + 1);
-        /* get the job we need to update */
-        job = getjobjid(jobs, jid);
-
-        if (job == NULL) {
-            printf("%s: No such job\n", argv[1]);
-            return;
-        }
-    } else if ( '0' < argv[1][0] && argv[1][0] <= '9') { /* pid */
-        /* pointer starts on the first character of the second argument (ex. 123) */
-        pid = atoi(argv[1]);
-        job = getjobpid(jobs, pid);
-
-        if (job == NULL) {
-            printf("(%d): No such process\n", pid);
-            return;
-        }
-    } else { /* neither */
-        printf("%s: argument must be a PID or %%jobid\n", argv[0]);
-        return;
-    }
-
-    /* Here we move the job to FG or BG */
-    if (!strcmp(argv[0], "bg")) {
-        job->state = BG;
-        Kill(-job->pid, SIGCONT);       /* send SIGCONT to entire group of job */
-        printf("[%d] (%d) %s", job->jid, job->pid, job->cmdline);
-    } else if (!strcmp(argv[0], "fg")) {
-        job->state = FG;
-        Kill(-job->pid, SIGCONT);       /* send SIGCONT to entire group of job */
-        waitfg(job->pid);               /* wait for foreground job to finish */
-    }
-    return;
-}
- 
-/*
- * waitfg - Block until process pid is no longer the foreground process
- */
-void waitfg(pid_t pid)
-{
-    //check if pid is valid
-    if (pid == 0) {
-        return;
-    }
-    if (getjobpid(jobs,pid) != NULL) {
-        //sleep
-        while(pid == fgpid(jobs)) {
-                sleep(1);
-        }
-    }
-    return;
-}
-
-/*****************
- * Signal handlers
- *****************/
-
-/*
- * sigchld_handler - The kernel sends a SIGCHLD to the shell whenever
- *     a child job terminates (becomes a zombie), or stops because it
- *     received a SIGSTOP or SIGTSTP signal. The handler reaps all
- *     available zombie children, but doesn't wait for any other
- *     currently running children to terminate.
- * 
- *  we are using asprintf() to build our 
- */
-void sigchld_handler(int sig)
-{
-    pid_t pid;              /* Process id of terminated child */
-    int childStatus;        /* Status of the child */
-    int old_errno = errno;  /* Back up errno */
-
-    /* no wrapper made for waitpid since it always eventually returns -1 when used in a while loop*/
-    while ((pid = waitpid(-1, &childStatus, WNOHANG|WUNTRACED)) > 0) {
-        if (WIFEXITED(childStatus)) {           /* Child terminated normally */ 
-            deletejob(jobs, pid);
-        }
-        else if (WIFSTOPPED(childStatus)) {     /* Child stopped */ 
-            getjobpid(jobs, pid)->state = ST;   /* Set job state to stopped */
-            /* 
-             * To print async signal safe we call sio_puts seperately for each 
-             * string between a variable and the variables themselves,
-             * We use sio_putl to print the variables after we cast them to long
-             */
-            Sio_puts("Job [");
-            Sio_putl((long)pid2jid(pid));
-            Sio_puts("] (");
-            Sio_putl((long)pid);
-            Sio_puts(") stopped by signal ");
-            Sio_putl((long)WSTOPSIG(childStatus));
-            Sio_puts("\n");
-        }
-        else if (WIFSIGNALED(childStatus)) {     /* Child terminated by uncaught signal */
-
-            Sio_puts("Job [");
-            Sio_putl((long)pid2jid(pid));
-            Sio_puts("] (");
-            Sio_putl((long)pid);
-            Sio_puts(") terminated by signal ");
-            Sio_putl((long)WTERMSIG(childStatus));
-            Sio_puts("\n");
-            deletejob(jobs, pid);
-        }
-        else {                                  /* Child terminated by unusual signal */
-            Sio_puts("child terminated abnormallly\n");
-        }
-    }
-    if (pid < 0 && errno != ECHILD) {           /* waitpid() failed with error other than ECHILD */
-        unix_error("Waitpid error");            /*   since the loop does not stop until waitpid() returns an error state */
-    }
-    errno = old_errno;                          /* Restore errno to it's previous state so that is is unalyered for the previus process */
-    return;
-}
-
-/*
- * sigint_handler - The kernel sends a SIGINT to the shell whenver the
- *    user types ctrl-c at the keyboard.  Catch it and send it along
- *    to the foreground job.
- */
-void sigint_handler(int sig)
-{
-    std_sig_handler(sig);
-    return;
-}
-
-/*
- * sigtstp_handler - The kernel sends a SIGTSTP to the shell whenever
- *     the user types ctrl-z at the keyboard. Catch it and suspend the
- *     foreground job by sending it a SIGTSTP.
- */
-void sigtstp_handler(int sig)
-{
-    std_sig_handler(sig);
-    return;   
-}
-
-/*
- * Standard sig handler so the other handlers aren't depending on each other
- */
-void std_sig_handler(int sig)
-{
-    int old_errno = errno;      /* Backing up errno so that is can be retored for the previous process incase kill() modifies it */
-    pid_t pid = fgpid(jobs);    /* Get the pid of the forground process */
-    if ((pid > 0) && (pid2jid(pid) > 0)) {
-        kill(-pid, sig);        /* Send a kill command with the passed signal parameter */
-    }
-    errno = old_errno;
-    return;
-}
-/*********************
- * End signal handlers
- *********************/
-
-/***********************************************
- * Helper routines that manipulate the job list
- **********************************************/
-
-/* clearjob - Clear the entries in a job struct */
-void clearjob(struct job_t *job)
-{
-    job->pid = 0;
-    job->jid = 0;
-    job->state = UNDEF;
-    job->cmdline[0] = '\0';
-}
-
-/* initjobs - Initialize the job list */
-void initjobs(struct job_t *jobs)
-{
-    int i;
-
-    for (i = 0; i < MAXJOBS; i++) {
-        clearjob(&jobs[i]);
-    }
-}
-
-/* maxjid - Returns largest allocated job ID */
-int maxjid(struct job_t *jobs)
-{
-    int i, max=0;
-
-    for (i = 0; i < MAXJOBS; i++) {
-        if (jobs[i].jid > max) {
-            max = jobs[i].jid;
-        }
-    }
-    return max;
-}
-
-/* addjob - Add a job to the job list */
-int addjob(struct job_t *jobs, pid_t pid, int state, char *cmdline)
-{
-    int i;
-    if (pid < 1) {
-        return 0;
-    }
-    for (i = 0; i < MAXJOBS; i++) {
-        if (jobs[i].pid == 0) {
-            jobs[i].pid = pid;
-            jobs[i].state = state;
-            jobs[i].jid = nextjid++;
-            if (nextjid > MAXJOBS)
-                nextjid = 1;
-            strcpy(jobs[i].cmdline, cmdline);
-            if (verbose) {
-                printf("Added job [%d] %d %s\n", jobs[i].jid, jobs[i].pid, jobs[i].cmdline);
-            }
-            return 1;
-        }
-    }
-    printf("Tried to create too many jobs\n");
-    return 0;
-}
-
-/* deletejob - Delete a job whose PID=pid from the job list */
-int deletejob(struct job_t *jobs, pid_t pid)
-{
-    int i;
-
-    if (pid < 1) {
-        return 0;
-    }
-
-    for (i = 0; i < MAXJOBS; i++) {
-        if (jobs[i].pid == pid) {
-            clearjob(&jobs[i]);
-            nextjid = maxjid(jobs)+1;
-            return 1;
-        }
-    }
-    return 0;
-}
-
-/* fgpid - Return PID of current foreground job, 0 if no such job */
-pid_t fgpid(struct job_t *jobs) {
-    int i;
-
-    for (i = 0; i < MAXJOBS; i++) {
-        if (jobs[i].state == FG) {
-            return jobs[i].pid;
-        }
-    }
-    return 0;
-}
-
-/* getjobpid  - Find a job (by PID) on the job list */
-struct job_t *getjobpid(struct job_t *jobs, pid_t pid) {
-    int i;
-
-    if (pid < 1) {
-        return NULL;
-    }
-    for (i = 0; i < MAXJOBS; i++) {
-        if (jobs[i].pid == pid) {
-            return &jobs[i];
-        }
-    }
-    return NULL;
-}
-
-/* getjobjid  - Find a job (by JID) on the job list */
-struct job_t *getjobjid(struct job_t *jobs, int jid)
-{
-    int i;
-
-    if (jid < 1) {
-        return NULL;
-    }
-    for (i = 0; i < MAXJOBS; i++) {
-        if (jobs[i].jid == jid) {
-            return &jobs[i];
-        }
-    }
-    return NULL;
-}
-
-/* pid2jid - Map process ID to job ID */
-int pid2jid(pid_t pid)
-{
-    int i;
-
-    if (pid < 1) {
-        return 0;
-    }
-    for (i = 0; i < MAXJOBS; i++) {
-        if (jobs[i].pid == pid) {
-            return jobs[i].jid;
-        }
-    }
-    return 0;
-}
-
-/* listjobs - Print the job list */
-void listjobs(struct job_t *jobs)
-{
-    int i;
-
-    for (i = 0; i < MAXJOBS; i++) {
-        if (jobs[i].pid != 0) {
-            printf("[%d] (%d) ", jobs[i].jid, jobs[i].pid);
-            switch (jobs[i].state) {
-            case BG:
-                printf("Running ");
-                break;
-            case FG:
-                printf("Foreground ");
-                break;
-            case ST:
-                printf("Stopped ");
-                break;
-            default:
-                printf("listjobs: Internal error: job[%d].state=%d ",
-                       i, jobs[i].state);
-            }
-            printf("%s", jobs[i].cmdline);
-        }
-    }
-}
-/******************************
- * end job list helper routines
- ******************************/
-
-
-/***********************
- * Other helper routines
- ***********************/
-
-/*
- * usage - print a help message
- */
-void usage(void)
-{
-    printf("Usage: shell [-hvp]\n");
-    printf("   -h   print this message\n");
-    printf("   -v   print additional diagnostic information\n");
-    printf("   -p   do not emit a command prompt\n");
-    exit(1);
-}
-
-/*
- * unix_error - unix-style error routine
- */
-void unix_error(char *msg)
-{
-    fprintf(stdout, "%s: %s\n", msg, strerror(errno));
-    exit(1);
-}
-
-/*
- * app_error - application-style error routine
- */
-void app_error(char *msg)
-{
-    fprintf(stdout, "%s\n", msg);
-    exit(1);
-}
-
-/*
- * Signal - wrapper for the sigaction function
- */
-handler_t *Signal(int signum, handler_t *handler)
-{
-    struct sigaction action, old_action;
-
-    action.sa_handler = handler;
-    sigemptyset(&action.sa_mask); /* block sigs of type being handled */
-    action.sa_flags = SA_RESTART; /* restart syscalls if possible */
-
-    if (sigaction(signum, &action, &old_action) < 0) {
-        unix_error("Signal error");
-    }
-    return (old_action.sa_handler);
-}
-
-/*
- * sigquit_handler - The driver program can gracefully terminate the
- *    child shell by sending it a SIGQUIT signal.
- */
-void sigquit_handler(int sig)
-{
-    printf("Terminating after receipt of SIGQUIT signal\n");
-    exit(1);
+/*
+ * tsh - A tiny shell program with job control
+ *
+ * === User information ===
+ * Group: Pending-group-name
+ * ===
+ * User 1: ernir17
+ * SSN: 180996-4279
+ * ===
+ * User 2: egilltor17
+ * SSN: 250697-2529
+ * ===
+ * User 3: hallgrimura17
+ * SSN: 040396-2929
+ * === End User Information ===
+ */
+
+#define _GNU_SOURCE         /* SCHED_BATCH and SCHED_IDLE */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <ctype.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sched.h>
+#include <time.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <fnmatch.h>
+#include <poll.h>
+#include <errno.h>
+#include "tsh.h"            /* MAXLINE, MAXJOBS, job states and struct job_t */
+
+/* Misc manifest constants */
+#define MAXARGS     128   /* max args on a command line */
+#define MAXJID    1<<16   /* max job ID */
+#define MAXDEADLINES (2*MAXJOBS+1) /* max pending job deadlines and wait timeout */
+#define MAXEVENTS    64   /* job state changes remembered for wait */
+#define ARENACHUNK (64*1024) /* bytes the command arena grows by */
+#define DIRCACHE     64   /* directory listings kept for globbing */
+#define DENTSBUF (64*1024) /* getdents64() buffer size */
+#define CACHEMAX (64<<20) /* default size bound of the cache store */
+#define CACHEHDR     14   /* bytes of the "tsh-cache NNN\n" entry header */
+#define SUBSTCHUNK (64*1024) /* initial buffer for the output of $(...) */
+#define CAPTURESIZE (16*1024) /* bytes of output kept per background job */
+#define MAXCAPTURES (2*MAXJOBS) /* captures of live and finished jobs */
+#define VARSINIT    256   /* initial slots of the variable table */
+#define KILLGRACE  2000   /* ms between SIGTERM and SIGKILL of a late job */
+#define MAXREDIRS    16   /* redirections of one command */
+#define SPECSIZE     32   /* bytes of a printf conversion the fast path hands on */
+
+/*
+ * Jobs states: FG (foreground), BG (background), ST (stopped)
+ * Job state transitions and enabling actions:
+ *     FG -> ST  : ctrl-z
+ *     ST -> FG  : fg command
+ *     ST -> BG  : bg command
+ *     BG -> FG  : fg command
+ * At most 1 job can be in the FG state.
+ */
+
+/* Global variables */
+extern char **environ;      /* defined in libc */
+char prompt[] = "tsh> ";    /* command line prompt (DO NOT CHANGE) */
+int verbose = 0;            /* if true, print additional output */
+int nextjid = 1;            /* next job ID to allocate */
+char sbuf[MAXLINE];         /* for composing sprintf messages */
+int fgnice = 0;             /* nice level of the foreground job */
+int bgnice = 10;            /* nice level of background jobs */
+int bgpolicy = SCHED_OTHER; /* scheduling policy of background jobs */
+int fastpath = 1;           /* run echo, true, false and printf in the shell */
+int capture = 0;            /* keep background output in per-job rings (-o) */
+
+/*
+ * The list operators as parseline() stores them. An unquoted operator
+ * word becomes a pointer to one of these strings, so a quoted one, or
+ * one that came out of a glob or $(...), is an ordinary word.
+ */
+char opsemi[] = ";", opbg[] = "&", opand[] = "&&", opor[] = "||";
+char *listops[] = { opsemi, opbg, opand, opor, NULL };
+char opsubst[] = "$(";      /* stands in front of the command of a $(...) */
+char opglob[] = "*";        /* stands in front of an unquoted glob pattern */
+char opin[] = "<", opout[] = ">", opappend[] = ">>", operrout[] = "2>&1";
+char opsized[] = ">!";      /* >!size, stored as opsized followed by the size */
+char *redirops[] = { opin, opout, opappend, operrout, opsized, NULL };
+
+char intstring[10];
+int laststatus = 0;         /* exit status of the last command, like $? */
+volatile sig_atomic_t interrupted = 0; /* ctrl-c with no foreground job */
+volatile sig_atomic_t reaped = 0; /* a job was deleted since the deadlines were pruned */
+unsigned long cachehits = 0;        /* cache builtin counters */
+unsigned long cachemisses = 0;
+unsigned long cacheevictions = 0;
+
+struct job_t jobs[MAXJOBS]; /* The job list */
+
+struct limits_t {           /* Resource limits of a job launch */
+    rlim_t cpu;             /* RLIMIT_CPU in seconds */
+    rlim_t as;              /* RLIMIT_AS in bytes */
+    rlim_t nofile;          /* RLIMIT_NOFILE */
+    long timeout;           /* wall-clock limit in ms, 0 for none */
+};                          /* unset rlimits are RLIM_INFINITY */
+
+struct redir_t {            /* I/O redirections of a command, in word order */
+    int n;                  /* number of ops */
+    struct {
+        int target;         /* 0, 1 or 2: the descriptor redirected */
+        int fd;             /* dup2()ed onto target when the op applies */
+        int opened;         /* fd is a file of ours rather than 2>&1's stdout */
+    } ops[MAXREDIRS];
+};
+
+struct deadline_t {         /* A pending job deadline */
+    long when;              /* CLOCK_MONOTONIC time in ms */
+    pid_t pid;              /* job PID */
+    int jid;                /* job ID, guards against PID reuse */
+    int sig;                /* signal to send to the job's group */
+};
+struct deadline_t deadlines[MAXDEADLINES]; /* Min-heap on when */
+int ndeadlines = 0;         /* Number of pending deadlines */
+
+struct event_t {            /* A job stopped or terminated */
+    pid_t pid;              /* job PID */
+    int jid;                /* job ID */
+    int status;             /* exit status, or 128+signal if killed or stopped */
+    int stopped;            /* true if the job only stopped */
+    int bg;                 /* true if it was not the foreground job, so its jid was shown */
+};
+struct event_t events[MAXEVENTS]; /* Ring of the latest job events */
+volatile unsigned long nevents = 0; /* Events ever recorded, next is events[nevents % MAXEVENTS] */
+
+struct arena_t {            /* A block of the command arena */
+    struct arena_t *next;   /* previously filled block */
+    size_t size;            /* bytes in data */
+    size_t used;            /* bytes handed out */
+    char data[];
+};
+struct arena_t *arena = NULL; /* Words and argv of the current command line */
+
+struct argvec_t {           /* An argv vector being built in the arena */
+    char **argv;            /* NULL terminated */
+    int argc;               /* words in argv */
+    int max;                /* room in argv, not counting the NULL */
+};
+
+struct dirlist_t {          /* A cached, sorted directory listing */
+    char *path;             /* directory as named in the pattern, NULL if unused */
+    dev_t dev;              /* identity of the directory ... */
+    ino_t ino;
+    struct timespec mtime;  /* ... and its mtime when it was read */
+    int racy;               /* mtime was the current tick, so a change might not move it */
+    char **names;           /* sorted entries, without . and .., each after its d_type */
+    int n;                  /* number of entries */
+    char *strings;          /* storage of the names */
+};
+struct dirlist_t dircache[DIRCACHE]; /* Hashed on path */
+
+struct capture_t {          /* Captured output of a background job */
+    int fd;                 /* read end of its stdout/stderr pipe, -1 at EOF */
+    pid_t pid;              /* job PID, 0 if the slot is free */
+    int jid;                /* job ID */
+    unsigned long seq;      /* order in which the slots were claimed */
+    unsigned long long total; /* bytes ever read, the ring ends at total % CAPTURESIZE */
+    unsigned long long shown; /* bytes already written to the terminal */
+    char ring[CAPTURESIZE]; /* the last CAPTURESIZE bytes */
+};
+struct capture_t captures[MAXCAPTURES]; /* Output captures */
+unsigned long captureseq = 0; /* Slots ever claimed */
+
+char tombstone[] = "";      /* marks a slot of vars whose variable was unset */
+char **vars = NULL;         /* Open addressing table of "NAME=value" strings */
+int varslots = 0;           /* Size of vars, a power of two */
+int nvars = 0;              /* Variables in vars */
+int varsused = 0;           /* Slots of vars that are not NULL, tombstones included */
+char **envcache = NULL;     /* Sorted variables, environ points here */
+/* End global variables */
+
+
+/* Function prototypes */
+pid_t Fork(void);
+int Kill(pid_t pid, int sig);
+int Execve(const char *filename, char *const argv[], char *const envp[]);
+int Sigemptyset(sigset_t *sig);
+int Sigaddset(sigset_t *sig, int signum);
+int Sigprocmask(int how, const sigset_t *restrict set, sigset_t *restrict oset);
+int Setpgid(pid_t pid, pid_t pgid);
+ssize_t Sio_puts(char s[]);
+ssize_t Sio_putl(long v);
+
+/* Functions extracted from csapp.c */
+ssize_t sio_puts(char s[]);
+static size_t sio_strlen(char s[]);
+void sio_error(char s[]);
+ssize_t sio_putl(long v);
+static void sio_ltoa(long v, char s[], int b);
+
+/* Here are the functions that you will implement */
+void eval(char *cmdline);
+void runlist(char **argv, int bg, char *cmdline);
+void oneshot(char *cmdline);
+int runcmd(char **argv, int bg, char *cmdline);
+int prepcmd(char **argv, int bg, char ***envp, struct limits_t *lim, struct redir_t *redir);
+pid_t launch(char **argv, int bg, char *cmdline, struct limits_t *lim, struct redir_t *redir, char **envp);
+int isoperator(char *word);
+int isop(char *word, char **ops);
+char *findop(char *word, char **ops);
+void joinwords(char *line, char **argv, int bg);
+int isbuiltin(char **argv, int bg);
+int builtin_cmd(char **argv, int bg, char **envp);
+void do_bgfg(char **argv);
+void waitfg(pid_t pid);
+void do_renice(char **argv);
+void do_wait(char **argv);
+void do_jobsout(char **argv);
+struct job_t *getjobarg(char *cmd, char *arg);
+
+/* Builtins that stand in for trivial programs */
+char *fastname(char *path);
+int do_echo(char **argv);
+int do_printf(char **argv);
+int printfok(char *format);
+char *convend(char *f);
+char *charconst(char *cmd, char *a, char *num);
+int badnum(char *cmd, char *a, char *end);
+int putescape(char **sp);
+
+/* Memoizing cache builtin */
+void do_cache(char **argv, int bg, char **envp);
+int cachedir(char *dir);
+int cachekey(char **cmd, char **envp, char **inputs, int ninputs, unsigned long long *key);
+unsigned long long fnv1a(unsigned long long h, const void *p, size_t n);
+void cacheevict(char *dir);
+void catfd(int fd);
+
+/* Job scheduling priorities */
+int jobnice(int state);
+int jobpolicy(int state);
+int setprio(pid_t pgid, int nice, int policy);
+int groupnice(pid_t pgid, int guess);
+
+/* Command arena, argv vectors and glob expansion */
+void *arenaalloc(size_t n);
+char *arenadup(const char *s, size_t n);
+void arenareset(void);
+void addarg(struct argvec_t *av, char *word);
+int globword(struct argvec_t *av, char *pattern);
+void globdir(struct argvec_t *av, char *dir, char *rest);
+struct dirlist_t *listdir(char *dir);
+int readdirlist(int fd, struct dirlist_t *dl);
+
+/* Command substitution */
+char *substend(char *s);
+int substitute(struct argvec_t *av, char *cmd);
+char **expand(char **argv);
+
+/* Background output capture */
+void initcaptures(void);
+struct capture_t *newcapture(int *wfd);
+struct capture_t *getcapture(pid_t pid);
+struct capture_t *findcapture(char *arg);
+void drain(struct capture_t *c);
+void flushcapture(struct capture_t *c, int all);
+int capturefds(struct pollfd *fds);
+void drainready(struct pollfd *fds, int n);
+void waitinput(void);
+void waitevent(sigset_t *prev);
+
+/* Environment variables */
+void initvars(void);
+int varslot(const char *name, size_t len);
+void setvar(const char *entry);
+void unsetvar(const char *name);
+void rebuildenv(void);
+static int envcmp(const void *a, const void *b);
+int isname(const char *s, size_t len);
+size_t assignlen(const char *word);
+char **parseassigns(char **argv);
+void do_export(char **argv);
+void do_unset(char **argv);
+
+/* I/O redirection */
+void noredirs(struct redir_t *r);
+int parseredirs(char **argv, struct redir_t *r);
+int openredir(struct redir_t *r, int target, char *path, int flags, off_t size);
+int addredir(struct redir_t *r, int target, int fd, int opened);
+int redirected(struct redir_t *r, int target);
+void setredirs(struct redir_t *r, int *saved);
+void restoreio(int *saved);
+void closeredirs(struct redir_t *r);
+
+/* Job resource limits and deadlines */
+int parselimits(char **argv, struct limits_t *lim);
+rlim_t parsesize(char *s);
+void setlimits(struct limits_t *lim);
+long nowms(void);
+int adddeadline(long when, pid_t pid, int jid, int sig);
+void prunedeadlines(void);
+struct deadline_t popdeadline(void);
+void deldeadline(pid_t pid, int jid, int sig);
+void siftdeadline(int i);
+void armdeadline(void);
+void sigalrm_handler(int sig);
+
+void sigchld_handler(int sig);
+void sigtstp_handler(int sig);
+void sigint_handler(int sig);
+void std_sig_handler(int sig);
+
+/* Here are helper routines that we've provided for you */
+int parseline(const char *cmdline, char ***argvp);
+void sigquit_handler(int sig);
+
+void clearjob(struct job_t *job);
+void initjobs(struct job_t *jobs);
+int maxjid(struct job_t *jobs);
+int addjob(struct job_t *jobs, pid_t pid, int state, char *cmdline);
+int deletejob(struct job_t *jobs, pid_t pid);
+pid_t fgpid(struct job_t *jobs);
+struct job_t *getjobpid(struct job_t *jobs, pid_t pid);
+struct job_t *getjobjid(struct job_t *jobs, int jid);
+int pid2jid(pid_t pid);
+void listjobs(struct job_t *jobs);
+int runningjobs(struct job_t *jobs);
+void addevent(pid_t pid, int status, int stopped);
+struct event_t *findevent(pid_t pid);
+struct event_t *findeventarg(char *arg);
+
+void usage(void);
+void unix_error(char *msg);
+void app_error(char *msg);
+typedef void handler_t(int);
+handler_t *Signal(int signum, handler_t *handler);
+
+/*
+ * main - The shell's main routine. Left out with -DTSH_NOMAIN, which
+ *    builds the rest of the shell as an object for tshbench.
+ */
+#ifndef TSH_NOMAIN
+int main(int argc, char **argv)
+{
+    char c;
+    char cmdline[MAXLINE];
+    int emit_prompt = 1; /* emit prompt (default) */
+    char *command = NULL; /* command line of -c */
+    sigset_t mask, prev;  /* blocked while the deadlines of reaped jobs are pruned */
+
+    /* Redirect stderr to stdout (so that driver will get all output
+     * on the pipe connected to stdout) */
+    dup2(1, 2);
+
+    /* Parse the command line */
+    while ((c = getopt(argc, argv, "hvpFon:N:s:c:")) != EOF) {
+        switch (c) {
+        case 'h':             /* print help message */
+            usage();
+            break;
+        case 'v':             /* emit additional diagnostic info */
+            verbose = 1;
+            break;
+        case 'p':             /* don't print a prompt */
+            emit_prompt = 0;  /* handy for automatic testing */
+            break;
+        case 'F':             /* fork and exec echo & co like tshref does */
+            fastpath = 0;
+            break;
+        case 'c':             /* run one command line and exit */
+            command = optarg;
+            break;
+        case 'o':             /* capture the output of background jobs */
+            capture = 1;
+            break;
+        case 'n':             /* nice level of background jobs */
+            bgnice = atoi(optarg);
+            break;
+        case 'N':             /* nice level of the foreground job */
+            fgnice = atoi(optarg);
+            break;
+        case 's':             /* scheduling policy of background jobs */
+            if (!strcmp(optarg, "batch")) {
+                bgpolicy = SCHED_BATCH;
+            } else if (!strcmp(optarg, "idle")) {
+                bgpolicy = SCHED_IDLE;
+            } else if (!strcmp(optarg, "other")) {
+                bgpolicy = SCHED_OTHER;
+            } else {
+                usage();
+            }
+            break;
+        default:
+            usage();
+        }
+    }
+
+    /* Install the signal handlers */
+
+    /* These are the ones you will need to implement */
+    Signal(SIGINT,  sigint_handler);   /* ctrl-c */
+    Signal(SIGTSTP, sigtstp_handler);  /* ctrl-z */
+    Signal(SIGCHLD, sigchld_handler);  /* Terminated or stopped child */
+    Signal(SIGALRM, sigalrm_handler);  /* A job deadline has passed */
+
+    /* This one provides a clean way to kill the shell */
+    Signal(SIGQUIT, sigquit_handler);
+
+    /* Initialize the job list and the environment */
+    initjobs(jobs);
+    initvars();
+    initcaptures();
+    if (capture) {
+        setvbuf(stdin, NULL, _IONBF, 0); /* so poll() on fd 0 sees every unread line */
+    }
+    if (command != NULL) {
+        oneshot(command);     /* does not return */
+    }
+
+    /* Execute the shell's read/eval loop */
+    while (1) {
+        /* Read command line */
+        if (emit_prompt) {
+            printf("%s", prompt);
+            fflush(stdout);
+        }
+        if (capture) {
+            waitinput();      /* keep draining background output meanwhile */
+        }
+        if ((fgets(cmdline, MAXLINE, stdin) == NULL) && ferror(stdin)) {
+            app_error("fgets error");
+        }
+        if (feof(stdin)) { /* End of file (ctrl-d) */
+            fflush(stdout);
+            exit(0);
+        }
+
+        /* Evaluate the command line */
+        eval(cmdline);
+        if (reaped) {
+            Sigemptyset(&mask);
+            Sigaddset(&mask, SIGCHLD);
+            Sigaddset(&mask, SIGALRM);
+            Sigprocmask(SIG_BLOCK, &mask, &prev);
+            prunedeadlines();
+            Sigprocmask(SIG_SETMASK, &prev, NULL);
+        }
+        fflush(stdout);
+        fflush(stdout);
+    }
+
+    exit(0); /* control never reaches here */
+}
+#endif /* TSH_NOMAIN */
+
+/*
+ * HELPER FUNCTIONS 
+ * Safe IO functions taken from csapp.c for use in signal handlers
+ */
+ssize_t sio_puts(char s[]) /* Put string */ {
+    return write(STDOUT_FILENO, s, sio_strlen(s)); //line:csapp:siostrlen
+}
+
+static size_t sio_strlen(char s[])
+{
+    int i = 0;
+
+    while (s[i] != '\0') {
+        ++i;
+    }
+    return i;
+}
+
+void sio_error(char s[]) /* Put error message and exit */
+{
+    sio_puts(s);
+    _exit(1);                                      //line:csapp:sioexit
+}
+
+/* sio_reverse - Reverse a string (from K&R) */
+static void sio_reverse(char s[])
+{
+    int c, i, j;
+
+    for (i = 0, j = strlen(s)-1; i < j; i++, j--) {
+        c = s[i];
+        s[i] = s[j];
+        s[j] = c;
+    }
+}
+
+/* Put long */
+ssize_t sio_putl(long v) 
+{
+    char s[128];
+    
+    sio_ltoa(v, s, 10); /* Based on K&R itoa() */  //line:csapp:sioltoa
+    return sio_puts(s);
+}
+
+/* sio_ltoa - Convert long to base b string (from K&R) */
+static void sio_ltoa(long v, char s[], int b) 
+{
+    int c, i = 0;
+    int neg = v < 0;
+
+    if (neg)
+	v = -v;
+
+    do {  
+        s[i++] = ((c = (v % b)) < 10)  ?  c + '0' : c - 10 + 'a';
+    } while ((v /= b) > 0);
+
+    if (neg)
+	s[i++] = '-';
+
+    s[i] = '\0';
+    sio_reverse(s);
+}
+/*
+ *  END OF HELPER FUNCTIONS
+ */
+
+
+/*
+ *  WRAPPER FUNCTIONS
+ */
+
+/* Wrapper for system function fork() */
+pid_t Fork(void)
+{
+	pid_t pid;                      /* Process id */
+	if ((pid = fork()) < 0) {
+		unix_error("fork error");
+    }
+    return pid;
+}
+
+/* Wrapper for system function kill() */
+int Kill(pid_t pid, int sig)
+{
+	int result;                     /* return form kill */
+	if ((result = kill(pid, sig)) < 0) {
+		unix_error("kill error");
+    }
+    return result;
+}
+
+/* Wrapper for system function execve() */
+int Execve(const char *filename, char *const argv[], char *const envp[])
+{
+	int result;
+	if ((result = execve(filename, argv, envp)) < 0) {
+		unix_error("execve error");
+    }
+    return result;
+}
+
+/* Wrapper for system function sigemptyset() */
+int Sigemptyset(sigset_t *sig)
+{
+	int result;
+	if ((result = sigemptyset(sig)) < 0) {
+		unix_error("sigemptyset error");
+    }
+    return result;
+}
+
+/* Wrapper for system function sigaddset() */
+int Sigaddset(sigset_t *sig, int signum)
+{
+	int result;
+	if ((result = sigaddset(sig, signum)) < 0) {
+		unix_error("sigaddset error");
+    }
+    return result;
+}
+
+/* Wrapper for system function sigprocmask() */
+int Sigprocmask(int how, const sigset_t *restrict set, sigset_t *restrict oset)
+{
+	int result;
+	if ((result = sigprocmask(how, set, oset)) < 0) {
+		unix_error("sigprocmask error");
+    }
+    return result;
+}
+
+/* Wrapper for system function setpgid() */
+int Setpgid(pid_t pid, pid_t pgid)
+{
+	int result;
+	if ((result = setpgid(pid, pgid)) < 0) {
+		unix_error("setpgid error");
+    }
+    return result;
+}
+
+/* Wrapper for csapp function sio_puts() */
+ssize_t Sio_puts(char s[])
+{
+    ssize_t n;
+    if ((n = sio_puts(s)) < 0) {
+	    sio_error("Sio_puts error");
+    }
+    return n;
+}
+
+/* Wrapper for csapp function sio_putl() */
+ssize_t Sio_putl(long v)
+{
+    ssize_t n;
+    if ((n = sio_putl(v)) < 0)
+	sio_error("Sio_putl error");
+    return n;
+}
+/*
+ *  END OF WRAPPER FUNCTIONS
+ */
+
+/*
+ * eval - Evaluate the command line that the user has just typed in
+ */
+void eval(char *cmdline)
+{
+	char **argv;				/* Argument list execve(), in the arena */
+	char buf[MAXLINE];			/* Holds modified command line */
+	int bg;						/* Should the last command run in bg or fg? */
+	
+	strcpy(buf, cmdline);
+    arenareset();               /* Words of the previous line are dead */
+	bg = parseline(buf, &argv);
+	if (argv[0] == NULL) {
+		return;					/* Ignore empty lines */
+	}
+    runlist(argv, bg, cmdline);
+}
+
+/*
+ * runlist - Run the parsed words of a command line
+ *
+ * The line is a list of commands separated by ;, &, && or || (each
+ * a word of its own, like &). && runs the next command only if the
+ * previous one succeeded, || only if it failed, judged by laststatus.
+ * A foreground job that is stopped or killed by ctrl-c ends the list.
+ * The $(...) and glob patterns of a command are expanded just before
+ * it runs, so a command that is skipped runs none of them and each
+ * sees what the ones before it did.
+ * Every command goes through runcmd().
+ */
+void runlist(char **argv, int bg, char *cmdline)
+{
+    char line[MAXLINE];         /* Command line of one command of a list */
+    char **cmd;                 /* Its words with the $(...) and globs expanded */
+    int i, start;               /* End and start of the current command in argv */
+    char *op = opsemi;          /* Operator in front of the current command */
+    char *next;                 /* Operator after it, NULL for the last one */
+    int cmdbg;                  /* Does the current command run in the background? */
+
+    for (start = 0; ; start = i + 1) {
+        for (i = start; argv[i] != NULL && !isoperator(argv[i]); i++) {
+            ;
+        }
+        if ((next = argv[i]) == NULL && start == 0) {
+            if ((cmd = expand(argv)) != NULL && cmd[0] != NULL) {
+                runcmd(cmd, bg, cmdline); /* Not a list, the job keeps the line as typed */
+            }
+            return;
+        }
+        argv[i] = NULL;
+
+        if (i > start && !(op == opand && laststatus != 0)
+                      && !(op == opor && laststatus == 0)) {
+            if ((cmd = expand(argv + start)) == NULL) {
+                return;         /* ctrl-c or ctrl-z in a $(...) ends the whole list */
+            }
+            cmdbg = (next == NULL) ? bg : next == opbg;
+            joinwords(line, cmd, cmdbg);
+            if (cmd[0] != NULL && runcmd(cmd, cmdbg, line)) {
+                return;         /* ctrl-c or ctrl-z ends the whole list */
+            }
+        }
+        if (next == NULL) {
+            return;
+        }
+        op = next;
+    }
+}
+
+/*
+ * oneshot - Run the command line of -c and exit with its status
+ *
+ * A simple foreground command replaces the shell: its assignments,
+ * limits and redirections are applied in place and the shell execve()s
+ * the program, so the command costs no fork and no job. Like a forked
+ * job it leads a process group of its own; a shell started by another
+ * job control shell already leads one, which stays the terminal's
+ * foreground group. Builtins run as usual. Lists, background jobs and
+ * wall-clock limits need the shell to stay around and get full job
+ * handling.
+ */
+void oneshot(char *cmdline)
+{
+    char **argv;                /* Argument list execve(), in the arena */
+    char buf[MAXLINE];          /* cmdline with the newline parseline wants */
+    struct limits_t lim;        /* Limits from a leading limit command */
+    struct redir_t redir;       /* Files the command reads and writes */
+    char **envp;                /* Environment of the command */
+    int i, bg;
+
+    if (strlen(cmdline) + 2 > MAXLINE) {
+        app_error("-c: command line too long");
+    }
+    sprintf(buf, "%s\n", cmdline);
+    arenareset();
+    bg = parseline(buf, &argv);
+    if (argv[0] == NULL) {
+        exit(0);
+    }
+    for (i = 0; argv[i] != NULL && !isoperator(argv[i]); i++) {
+        ;
+    }
+    if (bg || argv[i] != NULL) {
+        runlist(argv, bg, buf);
+        fflush(stdout);
+        exit(laststatus);
+    }
+    if ((argv = expand(argv)) == NULL || argv[0] == NULL) {
+        exit(laststatus);       /* ctrl-c in a $(...), or it left nothing to run */
+    }
+
+    if (prepcmd(argv, 0, &envp, &lim, &redir)) {
+        fflush(stdout);
+        exit(laststatus);       /* A builtin, or nothing to run */
+    }
+    if (lim.timeout > 0) {      /* Someone has to stay and enforce the deadline */
+        launch(argv, 0, buf, &lim, &redir, envp);
+        fflush(stdout);
+        exit(laststatus);
+    }
+
+    setpgid(0, 0);              /* Fails harmlessly if we lead a session */
+    setlimits(&lim);
+    setredirs(&redir, NULL);
+    if (setpriority(PRIO_PROCESS, 0, jobnice(FG)) < 0 && verbose) {
+        printf("oneshot: setpriority(%d): %s\n", jobnice(FG), strerror(errno));
+    }
+    Signal(SIGINT, SIG_DFL);    /* What a forked job would start with */
+    Signal(SIGTSTP, SIG_DFL);
+    Signal(SIGCHLD, SIG_DFL);
+    Signal(SIGALRM, SIG_DFL);
+    Signal(SIGQUIT, SIG_DFL);
+    fflush(stdout);
+    execve(argv[0], argv, envp ? envp : environ);
+    printf("%s: Command not found\n", argv[0]);
+    fflush(stdout);
+    exit(127);
+}
+
+/*
+ * runcmd - Run one command of a command line
+ *
+ * If the user has requested a built-in command (quit, jobs, bg or fg)
+ * then execute it immediately. Otherwise, fork a child process and
+ * run the job in the context of the child. If the job is running in
+ * the foreground, wait for it to terminate and then return.  Note:
+ * each child process must have a unique process group ID so that our
+ * background children don't receive SIGINT (SIGTSTP) from the kernel
+ * when we type ctrl-c (ctrl-z) at the keyboard.
+ *
+ * Returns 1 if the foreground job was stopped or killed by ctrl-c,
+ * 0 otherwise.
+ */
+int runcmd(char **argv, int bg, char *cmdline)
+{
+	pid_t pid;					/* Process id */
+    struct limits_t lim;        /* Limits from a leading limit command */
+    struct redir_t redir;       /* Files the command reads and writes */
+    struct event_t *ev;         /* How the foreground job ended */
+    char **envp;                /* Environment of the job */
+    int stop = 0;
+
+    if (prepcmd(argv, bg, &envp, &lim, &redir)) {
+        return 0;               /* A builtin, or nothing to launch */
+    }
+    pid = launch(argv, bg, cmdline, &lim, &redir, envp);
+    if (!bg) {
+        ev = findevent(pid);
+        stop = ev != NULL && (ev->stopped || ev->status == 128 + SIGINT);
+    }
+    closeredirs(&redir);
+	return stop;
+}
+
+/*
+ * prepcmd - Take the assignments, limit command and redirections out of
+ *    argv into *envp, lim and redir, and run argv if it is a builtin,
+ *    with its redirections in place. Only then are the shell's own
+ *    descriptors redirected; a launched command gets its redirections
+ *    in the child. Returns 1 if nothing is left to
+ *    launch: a builtin ran, there were only assignments or
+ *    redirections, or a bad limit or file was reported (laststatus 2
+ *    or 1). Otherwise returns 0 with the files of redir open.
+ */
+int prepcmd(char **argv, int bg, char ***envp, struct limits_t *lim, struct redir_t *redir)
+{
+    int saved[3];               /* The shell's own stdin, stdout and stderr */
+
+    if ((*envp = parseassigns(argv)) == NULL) {
+        return 1;               /* Only assignments, they went into the environment */
+    }
+    if (parselimits(argv, lim) < 0) {
+        laststatus = 2;
+        return 1;               /* Bad limit option, already reported */
+    }
+    if (parseredirs(argv, redir) < 0) {
+        laststatus = 1;
+        return 1;               /* Missing or unopenable file, already reported */
+    }
+    if (argv[0] == NULL) {
+        closeredirs(redir);     /* Only redirections, the files are created */
+        return 1;
+    }
+
+    if (!isbuiltin(argv, bg)) {
+        if (fastpath && !bg && !strcmp(argv[0], "printf")) {
+            argv[0] = "/bin/printf"; /* A format the fast path leaves to the program */
+        }
+        return 0;
+    }
+    setredirs(redir, saved);    /* A builtin runs with them in the shell */
+    builtin_cmd(argv, bg, *envp);
+    restoreio(saved);
+    closeredirs(redir);
+    return 1;
+}
+
+/*
+ * launch - Fork and exec argv as a new job with the given limits and
+ *    redirections (NULL for none) and environment (NULL for the
+ *    shell's). Waits for a foreground job, announces a background one.
+ *    Returns the PID of the job.
+ */
+pid_t launch(char **argv, int bg, char *cmdline, struct limits_t *lim, struct redir_t *redir, char **envp)
+{
+	pid_t pid;					/* Process id */
+    sigset_t mask, prev_one;    /* Mask for SIGCHLD and Mask backup */
+    struct job_t *job;          /* The new job */
+    struct capture_t *cap = NULL; /* Capture of its output */
+    int capfd = -1;             /* Write end of the capture pipe */
+
+    Sigemptyset(&mask);
+    Sigaddset(&mask, SIGCHLD);
+    Sigaddset(&mask, SIGALRM);
+    Sigprocmask(SIG_BLOCK, &mask, &prev_one);           /* Block SIGCHLD and SIGALRM */
+    fflush(stdout);                                     /* Child must not inherit buffered output */
+    if (capture && bg && (redir == NULL || !redirected(redir, STDOUT_FILENO))) {
+        cap = newcapture(&capfd);                       /* If there is no room, the job writes to the terminal */
+    }
+    /* Child runs user job */ 
+    if ((pid = Fork()) == 0) {                          /* Child */                          
+        Setpgid(0, 0);                                  /* Get new group for child process */
+        setprio(0, jobnice(2 - !bg), jobpolicy(2 - !bg)); /* Demoted before it can run or fork anything */
+        if (lim != NULL) {
+            setlimits(lim);                             /* Resource limits survive the exec */
+        }
+        if (redir != NULL) {
+            setredirs(redir, NULL);                     /* The files stay open across the exec */
+        }
+        if (cap != NULL) {
+            dup2(capfd, STDOUT_FILENO);
+            dup2(capfd, STDERR_FILENO);
+        }
+        Sigprocmask(SIG_SETMASK, &prev_one, NULL);      /* Unblock SIGCHLD */
+        if (execve(argv[0], argv, envp ? envp : environ) < 0) { /* Execute the command in the child process */
+            printf("%s: Command not found\n", argv[0]);
+            fflush(stdout);
+            _exit(127);                                 /* exit() would rewind a stdin shared with the shell */
+        }
+    }
+
+    /* Parent waits for child */
+    if (cap != NULL) {
+        close(capfd);                                   /* Only the job writes, so we see EOF when it is done */
+        cap->pid = pid;
+    }
+    setpgid(pid, pid);                                  /* Also from the parent, so the group exists before we touch it */
+    setprio(pid, jobnice(2 - !bg), jobpolicy(2 - !bg)); /* Also from the parent, so whoever runs first has applied it */
+    addjob(jobs, pid,(2 - !bg), cmdline);               /* Add child to joblist */
+    if ((job = getjobpid(jobs, pid)) != NULL) {
+        job->nice = groupnice(pid, jobnice(2 - !bg));   /* The boost may have been refused */
+    }
+    if (cap != NULL) {
+        cap->jid = pid2jid(pid);
+    }
+    if (lim != NULL && lim->timeout > 0                 /* Arm the wall-clock deadline */
+        && adddeadline(nowms() + lim->timeout, pid, pid2jid(pid), SIGTERM) < 0) {
+        printf("limit: no room for the timeout of job [%d] (%d)\n", pid2jid(pid), pid);
+    }
+    if (bg) {                                           /* Alert user of background process while it cannot be reaped yet */
+        printf("[%d] (%d) %s", pid2jid(pid), pid, cmdline);
+        fflush(stdout);                                 /* Ahead of anything sigchld_handler says about it */
+    }
+    Sigprocmask(SIG_SETMASK, &prev_one, NULL);          /* Unblock Parent */
+    if (!bg) {
+        waitfg(pid);                                    /* Parent waits for foreground job to terminate */
+    }
+    return pid;
+}
+
+/*
+ * isoperator - Is word one of the list operators ;, &, && and ||, as
+ *    parseline() stores them?
+ */
+int isoperator(char *word)
+{
+    return isop(word, listops);
+}
+
+/* isop - Is word one of the strings of ops (NULL terminated) itself? */
+int isop(char *word, char **ops)
+{
+    int i;
+
+    for (i = 0; ops[i] != NULL; i++) {
+        if (word == ops[i]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* findop - Return the string of ops that reads like word, or NULL */
+char *findop(char *word, char **ops)
+{
+    int i;
+
+    for (i = 0; ops[i] != NULL; i++) {
+        if (!strcmp(word, ops[i])) {
+            return ops[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * joinwords - Rebuild the command line of one command of a list from
+ *    its words, for the job list
+ */
+void joinwords(char *line, char **argv, int bg)
+{
+    int i, n = 0;
+
+    line[0] = '\0';
+    for (i = 0; argv[i] != NULL && n < MAXLINE - 4; i++) {
+        n += snprintf(line + n, MAXLINE - 4 - n,
+                      (i > 0 && argv[i - 1] != opsized) ? " %s" : "%s", argv[i]);
+    }
+    if (n > MAXLINE - 4) {
+        n = MAXLINE - 4;
+    }
+    strcpy(line + n, bg ? " &\n" : "\n");
+}
+
+/*
+ * parseline - Parse the command line and build the argv array.
+ *
+ * Characters enclosed in single quotes are treated as a single
+ * argument. Unquoted operator words are stored as the strings of
+ * listops and redirops, which is what makes them operators. A word of the form
+ * $(cmdline) is stored as opsubst followed by cmdline, and other words
+ * containing *, ? or [ as opglob followed by the pattern, for expand().
+ * argv is allocated in the command arena and grows as
+ * needed, so *argvp is valid until the next arenareset(). Return true
+ * if the user has requested a BG job, false if the user has requested
+ * a FG job.
+ */
+int parseline(const char *cmdline, char ***argvp)
+{
+    static char array[MAXLINE]; /* holds local copy of command line */
+    char *buf = array;          /* ptr that traverses command line */
+    char *delim;                /* points to first space delimiter */
+    struct argvec_t av;         /* args being built */
+    int quoted;                 /* was the current word quoted? */
+    int subst;                  /* is the current word a $(...)? */
+    char *op;                   /* operator the current word is */
+    int bg;                     /* background job? */
+
+    strcpy(buf, cmdline);
+    buf[strlen(buf)-1] = ' ';       /* replace trailing '\n' with space */
+    while (*buf && (*buf == ' ')) { /* ignore leading spaces */
+        buf++;
+    }
+
+    /* Build the argv list */
+    av.argc = 0;
+    av.max = MAXARGS;
+    av.argv = arenaalloc((av.max + 1) * sizeof(char *));
+    while (1) {
+        quoted = subst = 0;
+        if (*buf == '\'') {
+            quoted = 1;
+            buf++;
+            delim = strchr(buf, '\'');
+        }
+        else if (buf[0] == '$' && buf[1] == '(' && (delim = substend(buf + 2)) != NULL
+                 && delim[1] == ' ') {
+            subst = 1;
+            buf += 2;                   /* delim is the closing ) */
+        }
+        else {
+            delim = strchr(buf, ' ');
+        }
+        if (delim == NULL) {
+            break;
+        }
+
+        *delim = '\0';
+        if (subst) {
+            addarg(&av, opsubst);       /* run by expand() when its command is due */
+            addarg(&av, buf);
+        }
+        else if (!quoted && ((op = findop(buf, listops)) != NULL
+                             || (op = findop(buf, redirops)) != NULL)) {
+            addarg(&av, op);            /* only this copy is taken as an operator */
+        }
+        else if (!quoted && buf[0] == '>' && buf[1] == '!' && parsesize(buf + 2) > 0) {
+            addarg(&av, opsized);
+            addarg(&av, buf + 2);
+        }
+        else if (!quoted && strpbrk(buf, "*?[") != NULL) {
+            addarg(&av, opglob);        /* matched by expand() when its command is due */
+            addarg(&av, buf);
+        }
+        else {
+            addarg(&av, buf);
+        }
+        buf = delim + 1;
+        while (*buf && (*buf == ' ')) { /* ignore spaces */
+            buf++;
+        }
+    }
+    av.argv[av.argc] = NULL;
+    *argvp = av.argv;
+
+    if (av.argc == 0) { /* ignore blank line */
+        return 1;
+    }
+
+    /* should the job run in the background? */
+    if ((bg = (av.argv[av.argc-1] == opbg)) != 0) {
+        av.argv[--av.argc] = NULL;
+    }
+    return bg;
+}
+
+/*
+ * isbuiltin - Return true if builtin_cmd() runs argv in the shell
+ *    rather than leaving it to be launched
+ */
+int isbuiltin(char **argv, int bg)
+{
+    static char *builtins[] = { "status", "quit", "jobs", "fg", "bg", "renice",
+                                "wait", "export", "unset", "cache", "&", NULL };
+    static char *fastcmds[] = { "echo", "printf", "true", "false", NULL };
+    char *name;                         /* Program the fast path stands in for */
+    int i;
+
+    for (i = 0; builtins[i] != NULL; i++) {
+        if (!strcmp(argv[0], builtins[i])) {
+            return 1;
+        }
+    }
+    if (!strcmp(argv[0], "env")) {
+        return argv[1] == NULL;         /* env with a command is the program */
+    }
+    if (fastpath && !bg && (name = fastname(argv[0])) != NULL) {
+        if (!strcmp(name, "printf") && argv[1] != NULL && !printfok(argv[1])) {
+            return 0;                   /* A conversion only the program has */
+        }
+        for (i = 0; fastcmds[i] != NULL; i++) {
+            if (!strcmp(name, fastcmds[i])) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * builtin_cmd - If the user has typed a built-in command then execute
+ *    it immediately. Foreground echo, true, false and printf (bare or
+ *    as /bin/x or /usr/bin/x) are also run here, sparing a fork and exec
+ *    for what is usually a single write, unless -F was given. envp is
+ *    the environment from parseassigns(), which env and cache pass on.
+ */
+int builtin_cmd(char **argv, int bg, char **envp)
+{
+    char *name;                         /* Program the fast path stands in for */
+    int i;
+
+    if (!isbuiltin(argv, bg)) {
+        return 0;                       /* Not a builtin command */
+    }
+    if (!strcmp(argv[0], "status")) {   /* status command, like echo $? */
+        printf("%d\n", laststatus);
+        return 1;
+    }
+    laststatus = 0;                     /* builtins succeed unless they say otherwise */
+
+	if (!strcmp(argv[0], "quit")) { 	/* quit command */
+        exit(0);
+    }
+    if (!strcmp(argv[0], "jobs")) {     /* jobs command */
+        if (argv[1] != NULL && !strcmp(argv[1], "-o")) {
+            do_jobsout(argv);           /* jobs -o %jid|pid */
+            return 1;
+        }
+        listjobs(jobs);
+        return 1;
+    }
+	if (!strcmp(argv[0], "fg") || !strcmp(argv[0], "bg")) { /* fg or bg command */
+        do_bgfg(argv);
+        return 1;
+    }
+    if (!strcmp(argv[0], "renice")) {   /* renice command */
+        do_renice(argv);
+        return 1;
+    }
+    if (!strcmp(argv[0], "wait")) {     /* wait command */
+        do_wait(argv);
+        return 1;
+    }
+    if (!strcmp(argv[0], "export")) {   /* export command */
+        do_export(argv);
+        return 1;
+    }
+    if (!strcmp(argv[0], "unset")) {    /* unset command */
+        do_unset(argv);
+        return 1;
+    }
+    if (!strcmp(argv[0], "env") && argv[1] == NULL) { /* env command */
+        for (i = 0; envp[i] != NULL; i++) {
+            printf("%s\n", envp[i]);
+        }
+        return 1;
+    }
+    if (!strcmp(argv[0], "cache")) {    /* cache command */
+        do_cache(argv, bg, envp);
+        return 1;
+    }
+    if (!strcmp(argv[0], "&")) {		/* Ignore singleton & */
+        return 1;
+    }
+    if (fastpath && !bg && (name = fastname(argv[0])) != NULL) {
+        if (!strcmp(name, "echo")) {
+            laststatus = do_echo(argv);
+            return 1;
+        }
+        if (!strcmp(name, "printf")) {
+            laststatus = do_printf(argv);
+            return 1;
+        }
+        if (!strcmp(name, "true") || !strcmp(name, "false")) {
+            laststatus = (name[0] == 'f');
+            return 1;
+        }
+    }
+    return 0;							/* Not a builtin command */
+}
+
+/*
+ * do_bgfg - Execute the builtin bg and fg commands
+ *
+ * The job takes the scheduling class of its new state. Boosting it
+ * back to the foreground nice level needs CAP_SYS_NICE or a matching
+ * RLIMIT_NICE, so without them an fg job keeps its background level
+ * and job->nice says so.
+ */
+void do_bgfg(char **argv)
+{
+    struct job_t *job;                  /* Job list */
+
+    /* checks if function has second argument */
+    if (argv[1] == NULL) {
+        printf("%s command requires PID or %%jobid argument\n", argv[0]);
+        laststatus = 1;
+        return;
+    }
+    if ((job = getjobarg(argv[0], argv[1])) == NULL) {
+        return;
+    }
+
+    /* Here we move the job to FG or BG */
+    if (!strcmp(argv[0], "bg")) {
+        job->state = BG;
+        setprio(job->pid, jobnice(BG), jobpolicy(BG)); /* demote before it runs again */
+        job->nice = groupnice(job->pid, jobnice(BG));
+        Kill(-job->pid, SIGCONT);       /* send SIGCONT to entire group of job */
+        printf("[%d] (%d) %s", job->jid, job->pid, job->cmdline);
+    } else if (!strcmp(argv[0], "fg")) {
+        job->state = FG;
+        setprio(job->pid, jobnice(FG), jobpolicy(FG)); /* boost before it runs again */
+        job->nice = groupnice(job->pid, job->nice);
+        if (getcapture(job->pid) != NULL) {
+            drain(getcapture(job->pid)); /* show what it wrote in the background */
+        }
+        Kill(-job->pid, SIGCONT);       /* send SIGCONT to entire group of job */
+        waitfg(job->pid);               /* wait for foreground job to finish */
+    }
+    return;
+}
+
+/*
+ * getjobarg - Find the job named by the PID or %jobid argument of a
+ *    builtin command. Prints the reason and returns NULL if there is
+ *    no such job.
+ */
+struct job_t *getjobarg(char *cmd, char *arg)
+{
+    struct job_t *job;                  /* Job list */
+    int jid;                            /* Job id */
+    pid_t pid;                          /* Process id of child or null */
+
+    /*
+     * the following three if statements read the first
+     * character from the argument to see whether it
+     * is a jid or a pid or neither
+     */ 
+    if (arg[0] == '%') { /* jid */
+        /*
+         * pointer starts on the second character of the argument (ex. %123)
+         * since the '%' symbol is only used to differentiate between pid and jid
+         * and not a part of the jid itself 
+         */
+        jid = atoi(arg + 1);
+        job = getjobjid(jobs, jid);
+
+        if (job == NULL) {
+            printf("%s: No such job\n", arg);
+        }
+    } else if ( '0' < arg[0] && arg[0] <= '9') { /* pid */
+        /* pointer starts on the first character of the argument (ex. 123) */
+        pid = atoi(arg);
+        job = getjobpid(jobs, pid);
+
+        if (job == NULL) {
+            printf("(%d): No such process\n", pid);
+        }
+    } else { /* neither */
+        printf("%s: argument must be a PID or %%jobid\n", cmd);
+        job = NULL;
+    }
+    if (job == NULL) {
+        laststatus = 1;
+    }
+    return job;
+}
+
+/*
+ * do_renice - Execute the builtin renice command
+ *
+ *    renice %jid|pid         print the nice level of the job
+ *    renice %jid|pid <n>     move the job's process group to nice level n
+ *
+ * The level sticks until the job next moves between FG and BG, which
+ * reapplies the scheduling class of the new state.
+ */
+void do_renice(char **argv)
+{
+    struct job_t *job;                  /* Job to renice */
+    char *end;                          /* End of the nice level argument */
+    long nice;                          /* New nice level */
+
+    if (argv[1] == NULL) {
+        printf("%s command requires PID or %%jobid argument\n", argv[0]);
+        laststatus = 1;
+        return;
+    }
+    if ((job = getjobarg(argv[0], argv[1])) == NULL) {
+        return;
+    }
+    if (argv[2] == NULL) {
+        printf("[%d] (%d) nice %d\n", job->jid, job->pid, job->nice);
+        return;
+    }
+
+    nice = strtol(argv[2], &end, 10);
+    if (*argv[2] == '\0' || *end != '\0') {
+        printf("%s: nice level must be an integer\n", argv[0]);
+        laststatus = 1;
+        return;
+    }
+    if (setprio(job->pid, (int)nice, -1) < 0) {
+        printf("%s: %s\n", argv[0], strerror(errno));
+        laststatus = 1;
+        return;
+    }
+    job->nice = (int)nice;
+    return;
+}
+
+/*
+ * jobnice - Nice level of the scheduling class of a job state. The
+ *    foreground job runs at fgnice so it keeps ahead of background work.
+ */
+int jobnice(int state)
+{
+    return (state == FG) ? fgnice : bgnice;
+}
+
+/*
+ * jobpolicy - Scheduling policy of the scheduling class of a job state
+ */
+int jobpolicy(int state)
+{
+    return (state == FG) ? SCHED_OTHER : bgpolicy;
+}
+
+/*
+ * setprio - Move the process group pgid (0 for the caller's own group)
+ *    to the given nice level and, unless policy is -1, the given
+ *    scheduling policy.
+ *
+ *    The nice level covers the whole group, but the policy can only be
+ *    set per process, so it is applied to the group leader and inherited
+ *    by whatever the leader forks afterwards. Lowering the nice level
+ *    needs CAP_SYS_NICE or a matching RLIMIT_NICE, so a failed boost is
+ *    not fatal; it is only reported in verbose mode.
+ */
+int setprio(pid_t pgid, int nice, int policy)
+{
+    struct sched_param param;           /* Static priority, always 0 for these policies */
+    int result = 0;
+
+    if (setpriority(PRIO_PGRP, pgid, nice) < 0) {
+        result = -1;
+        if (verbose) {
+            printf("setprio: setpriority(%d, %d): %s\n", pgid, nice, strerror(errno));
+        }
+    }
+    if (policy >= 0) {
+        param.sched_priority = 0;
+        if (sched_setscheduler(pgid, policy, &param) < 0) {
+            result = -1;
+            if (verbose) {
+                printf("setprio: sched_setscheduler(%d, %d): %s\n", pgid, policy, strerror(errno));
+            }
+        }
+    }
+    return result;
+}
+
+/*
+ * groupnice - Nice level of process group pgid as the kernel has it,
+ *    which is that of its least nice member. Returns guess if the group
+ *    is already gone.
+ */
+int groupnice(pid_t pgid, int guess)
+{
+    int nice;
+
+    errno = 0;
+    nice = getpriority(PRIO_PGRP, pgid);
+    return (nice == -1 && errno != 0) ? guess : nice;
+}
+ 
+/*
+ * do_wait - Execute the builtin wait command
+ *
+ *    wait [-t secs]                 wait until no job is running
+ *    wait [-t secs] %jid|pid ...    wait until the named jobs stop running
+ *    wait [-t secs] -n              wait until the next job terminates
+ *
+ * The exit status of the job waited for, or 128+signal if it was killed
+ * or stopped, becomes laststatus. A named job that has already
+ * terminated is looked up among the last MAXEVENTS job events, so
+ * waiting for it afterwards still gives its status. Running out of time gives 124, ctrl-c
+ * gives 130 and having nothing to wait for gives 127. The shell sleeps
+ * in sigsuspend() until sigchld_handler has recorded an event (or the
+ * timeout's SIGALRM arrives) and then rechecks, so it never polls.
+ */
+void do_wait(char **argv)
+{
+    pid_t pids[MAXARGS];                /* Jobs named on the command line */
+    int nargs = 0, npids = 0, any = 0;  /* Job arguments, jobs found, -n given? */
+    long timeout = 0, deadline = 0;     /* -t in ms, and when it runs out */
+    unsigned long seen;                 /* Events before we started waiting */
+    struct job_t *job;                  /* Job named by an argument */
+    struct event_t *ev;                 /* Event of a job that is done */
+    pid_t pid;                          /* Job named by an argument */
+    sigset_t mask, prev;                /* SIGCHLD and SIGALRM are blocked between checks */
+    char *end;                          /* End of the -t argument */
+    int i, status = 127;
+
+    for (i = 1; argv[i] != NULL && argv[i][0] == '-'; i++) {
+        if (!strcmp(argv[i], "-n")) {
+            any = 1;
+        } else if (!strcmp(argv[i], "-t") && argv[i + 1] != NULL
+                   && strtod(argv[i + 1], &end) > 0 && *end == '\0') {
+            timeout = (long)(strtod(argv[++i], NULL) * 1000) + 1;
+        } else {
+            printf("%s: usage: wait [-n] [-t secs] [%%jobid|pid ...]\n", argv[0]);
+            laststatus = 2;
+            return;
+        }
+    }
+    for (; argv[i] != NULL; i++, nargs++) {
+        if ((ev = findeventarg(argv[i])) != NULL) {
+            pid = ev->pid;              /* already done, its status is remembered */
+        } else if ((job = getjobarg(argv[0], argv[i])) != NULL) {
+            pid = job->pid;
+        } else {
+            continue;
+        }
+        if (npids < MAXARGS) {
+            pids[npids++] = pid;
+        }
+    }
+    if (nargs > 0 && npids == 0) {
+        laststatus = 127;               /* none of the named jobs exist */
+        return;
+    }
+
+    Sigemptyset(&mask);
+    Sigaddset(&mask, SIGCHLD);
+    Sigaddset(&mask, SIGALRM);
+    Sigprocmask(SIG_BLOCK, &mask, &prev);
+    if (timeout > 0) {
+        deadline = nowms() + timeout;
+        if (adddeadline(deadline, 0, 0, 0) < 0) { /* a wakeup, not tied to any job */
+            Sigprocmask(SIG_SETMASK, &prev, NULL);
+            printf("%s: no room for the timeout\n", argv[0]);
+            laststatus = 1;
+            return;
+        }
+    }
+    seen = nevents;
+    interrupted = 0;
+
+    while (1) {
+        if (any) {                      /* the next termination after seen */
+            for (; seen < nevents; seen++) {
+                ev = &events[seen % MAXEVENTS];
+                if (!ev->stopped) {
+                    break;
+                }
+            }
+            if (seen < nevents) {
+                status = events[seen % MAXEVENTS].status;
+                break;
+            }
+            if (!runningjobs(jobs)) {
+                status = 127;
+                break;
+            }
+        } else if (npids > 0) {         /* every named job is done or stopped */
+            for (i = 0; i < npids; i++) {
+                if ((job = getjobpid(jobs, pids[i])) != NULL && job->state != ST) {
+                    break;
+                }
+            }
+            if (i == npids) {
+                ev = findevent(pids[npids - 1]);
+                status = (ev != NULL) ? ev->status : 0;
+                break;
+            }
+        } else if (!runningjobs(jobs)) {
+            status = 0;
+            break;
+        }
+        if (timeout > 0 && nowms() >= deadline) {
+            status = 124;
+            break;
+        }
+        if (interrupted) {
+            status = 130;
+            break;
+        }
+        waitevent(&prev);               /* sleep until a handler has run */
+    }
+
+    if (timeout > 0) {
+        deldeadline(0, 0, 0);
+    }
+    Sigprocmask(SIG_SETMASK, &prev, NULL);
+    laststatus = status;
+    if (verbose) {
+        printf("wait: status %d\n", status);
+    }
+    return;
+}
+
+/*
+ * do_jobsout - Execute the builtin jobs -o %jid|pid, which prints the
+ *    captured tail of a job's output (also of a job that has finished,
+ *    as long as its capture has not been reused)
+ */
+void do_jobsout(char **argv)
+{
+    struct capture_t *c;                /* Capture of the job */
+
+    if (argv[2] == NULL) {
+        printf("%s -o command requires PID or %%jobid argument\n", argv[0]);
+        laststatus = 1;
+        return;
+    }
+    if ((c = findcapture(argv[2])) == NULL) {
+        printf("%s: No captured output\n", argv[2]);
+        laststatus = 1;
+        return;
+    }
+    drain(c);
+    flushcapture(c, 1);
+    return;
+}
+
+/*
+ * waitfg - Block until process pid is no longer the foreground process
+ */
+void waitfg(pid_t pid)
+{
+    sigset_t mask, prev;                /* SIGCHLD is blocked between checks */
+    struct event_t *ev;                 /* Latest event of the job */
+
+    //check if pid is valid
+    if (pid == 0) {
+        return;
+    }
+    Sigemptyset(&mask);
+    Sigaddset(&mask, SIGCHLD);
+    Sigprocmask(SIG_BLOCK, &mask, &prev);
+    while (pid == fgpid(jobs)) {
+        waitevent(&prev);               /* sleep until sigchld_handler has run */
+    }
+    if ((ev = findevent(pid)) != NULL) {
+        laststatus = ev->status;        /* how the job exited, was killed or stopped */
+    }
+    Sigprocmask(SIG_SETMASK, &prev, NULL);
+    return;
+}
+
+/*
+ * fastname - Return the command name of path if it is a bare name or
+ *    lives in /bin or /usr/bin, where echo and friends are the standard
+ *    programs. Returns NULL for any other path.
+ */
+char *fastname(char *path)
+{
+    if (!strncmp(path, "/bin/", 5)) {
+        path += 5;
+    } else if (!strncmp(path, "/usr/bin/", 9)) {
+        path += 9;
+    }
+    return strchr(path, '/') ? NULL : path;
+}
+
+/*
+ * do_echo - Execute echo [-neE] [arg ...] inside the shell, the way
+ *    coreutils echo does: -n drops the newline, -e interprets backslash
+ *    escapes and -E (the default) does not. Returns the exit status.
+ */
+int do_echo(char **argv)
+{
+    int i, newline = 1, escapes = 0;    /* Print the newline? Interpret escapes? */
+    char *s;                            /* Option or argument being printed */
+
+    /* an option word is '-' followed only by n, e and E */
+    for (i = 1; argv[i] != NULL && argv[i][0] == '-' && argv[i][1] != '\0'; i++) {
+        if (strspn(argv[i] + 1, "neE") != strlen(argv[i] + 1)) {
+            break;
+        }
+        for (s = argv[i] + 1; *s; s++) {
+            if (*s == 'n') {
+                newline = 0;
+            } else {
+                escapes = (*s == 'e');
+            }
+        }
+    }
+
+    for (; argv[i] != NULL; i++) {
+        s = argv[i];
+        if (!escapes) {
+            fputs(s, stdout);
+        } else {
+            while (*s) {
+                if (*s != '\\' || s[1] == '\0') {
+                    putchar(*s++);
+                } else if (s++, putescape(&s)) {
+                    return 0;           /* \c: no further output at all */
+                }
+            }
+        }
+        if (argv[i + 1] != NULL) {
+            putchar(' ');
+        }
+    }
+    if (newline) {
+        putchar('\n');
+    }
+    return 0;
+}
+
+/*
+ * do_printf - Execute printf format [arg ...] inside the shell. The
+ *    format takes the escapes of echo -e and the conversions %s, %b, %c,
+ *    %d, %i, %u, %o, %x, %X, %e, %f, %g and %% with flags, width and
+ *    precision. It is reused until the arguments run out, missing
+ *    arguments count as empty or zero. A numeric argument that does
+ *    not convert completely is reported and makes the status 1, as in
+ *    coreutils. Returns the exit status.
+ */
+int do_printf(char **argv)
+{
+    char **arg;                         /* Next argument to convert */
+    char *f, *start, *a;                /* Format position, start of a conversion, its argument */
+    char spec[SPECSIZE];                /* One conversion, handed to printf() */
+    char *end;                          /* Where the conversion of a stopped */
+    char num[4];                        /* Character constant as a number */
+    long long ll;
+    unsigned long long ull;
+    double d;
+    int status = 0;
+
+    if (argv[1] == NULL) {
+        printf("%s: missing operand\n", argv[0]);
+        printf("Try '%s --help' for more information.\n", argv[0]);
+        return 1;
+    }
+
+    arg = argv + 2;
+    do {
+        for (f = argv[1]; *f; ) {
+            if (*f == '\\' && f[1] != '\0') {
+                f++;
+                if (putescape(&f)) {
+                    return status;      /* \c ends the output */
+                }
+                continue;
+            }
+            if (*f != '%' || f[1] == '\0') {
+                putchar(*f++);
+                continue;
+            }
+            if (f[1] == '%') {
+                putchar('%');
+                f += 2;
+                continue;
+            }
+
+            /* copy %[flags][width][.precision] into spec */
+            start = f;
+            f = convend(f);
+            if (*f == '\0' || f - start + sizeof("lld") > sizeof(spec)) { /* printfok() lets neither through */
+                printf("%s: invalid conversion %s\n", argv[0], start);
+                return 1;
+            }
+            memcpy(spec, start, f - start);
+            spec[f - start] = '\0';
+            a = (*arg != NULL) ? *arg++ : "";
+
+            switch (*f) {
+            case 's':
+                strcat(spec, "s");
+                printf(spec, a);
+                break;
+            case 'b':                   /* %b: the argument with echo -e escapes */
+                while (*a) {
+                    if (*a != '\\' || a[1] == '\0') {
+                        putchar(*a++);
+                    } else if (a++, putescape(&a)) {
+                        return status;
+                    }
+                }
+                break;
+            case 'c':
+                strcat(spec, "c");
+                printf(spec, *a);
+                break;
+            case 'd': case 'i':
+                strcat(spec, "lld");
+                a = charconst(argv[0], a, num);
+                errno = 0;
+                ll = strtoll(a, &end, 0);
+                status |= badnum(argv[0], a, end);
+                printf(spec, ll);
+                break;
+            case 'u': case 'o': case 'x': case 'X':
+                strcat(spec, "ll");
+                spec[strlen(spec) + 1] = '\0';
+                spec[strlen(spec)] = *f;
+                a = charconst(argv[0], a, num);
+                errno = 0;
+                ull = strtoull(a, &end, 0);
+                status |= badnum(argv[0], a, end);
+                printf(spec, ull);
+                break;
+            case 'e': case 'f': case 'g': case 'E': case 'G':
+                spec[strlen(spec) + 1] = '\0';
+                spec[strlen(spec)] = *f;
+                a = charconst(argv[0], a, num);
+                errno = 0;
+                d = strtod(a, &end);
+                status |= badnum(argv[0], a, end);
+                printf(spec, d);
+                break;
+            default:
+                printf("%s: invalid conversion %s\n", argv[0], start);
+                return 1;
+            }
+            f++;
+        }
+    } while (*arg != NULL && arg > argv + 2);
+    return status;
+}
+
+/*
+ * printfok - Return true if do_printf() implements every conversion of
+ *    format, so the fast path can stand in for the program. Anything
+ *    else, such as %q, %a, a length modifier or a * width, is left to
+ *    the program itself.
+ */
+int printfok(char *format)
+{
+    char *f, *start;
+
+    for (f = format; *f; f++) {
+        if (*f == '\\' && f[1] != '\0') {
+            f++;                        /* no escape takes a % after its first character */
+        } else if (*f == '%' && f[1] == '%') {
+            f++;
+        } else if (*f == '%' && f[1] != '\0') {
+            start = f;
+            f = convend(f);
+            if (*f == '\0' || strchr("sbcdiuoxXefgEG", *f) == NULL
+                || f - start + sizeof("lld") > SPECSIZE) { /* room for the longest suffix and the NUL */
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/*
+ * convend - Return the conversion character of the printf conversion
+ *    at f, past its %, flags, width and precision
+ */
+char *convend(char *f)
+{
+    f++;
+    f += strspn(f, "-+ #0");
+    f += strspn(f, "0123456789");
+    if (*f == '.') {
+        f++;
+        f += strspn(f, "0123456789");
+    }
+    return f;
+}
+
+/*
+ * charconst - Return the numeric argument a of printf, or if it is a
+ *    character constant ('c or "c) the code of that character written
+ *    into num. Characters after the first are ignored with a warning.
+ */
+char *charconst(char *cmd, char *a, char *num)
+{
+    if ((*a != '\'' && *a != '"') || a[1] == '\0') {
+        return a;
+    }
+    if (a[2] != '\0') {
+        printf("%s: warning: %s: character(s) following character constant have been ignored\n",
+               cmd, a + 2);
+    }
+    sprintf(num, "%d", (unsigned char)a[1]);
+    return num;
+}
+
+/*
+ * badnum - Report a numeric argument a of printf that did not convert
+ *    completely: strto*() stopped at end with errno as it left it. An
+ *    empty argument is zero. Returns 1 if a was reported, else 0.
+ */
+int badnum(char *cmd, char *a, char *end)
+{
+    if (*a == '\0') {
+        return 0;
+    }
+    if (end == a) {
+        printf("%s: '%s': expected a numeric value\n", cmd, a);
+        return 1;
+    }
+    if (*end != '\0') {
+        printf("%s: '%s': value not completely converted\n", cmd, a);
+        return 1;
+    }
+    if (errno == ERANGE) {
+        printf("%s: '%s': %s\n", cmd, a, strerror(ERANGE));
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * putescape - Print the backslash escape that starts at *sp (just past
+ *    the backslash) and advance *sp over it. Returns 1 for \c, which
+ *    ends all output of the command, and 0 otherwise.
+ */
+int putescape(char **sp)
+{
+    char *s = *sp;
+    int c, n;
+
+    switch (c = *s++) {
+    case 'a': c = '\a'; break;
+    case 'b': c = '\b'; break;
+    case 'c': *sp = s; return 1;
+    case 'e': c = 033; break;
+    case 'f': c = '\f'; break;
+    case 'n': c = '\n'; break;
+    case 'r': c = '\r'; break;
+    case 't': c = '\t'; break;
+    case 'v': c = '\v'; break;
+    case '\\': break;
+    case 'x':                           /* \xHH, one or two hex digits */
+        if (!isxdigit((unsigned char)*s)) {
+            putchar('\\');
+            break;
+        }
+        for (c = 0, n = 0; n < 2 && isxdigit((unsigned char)*s); n++, s++) {
+            c = c * 16 + (isdigit((unsigned char)*s) ? *s - '0' : tolower((unsigned char)*s) - 'a' + 10);
+        }
+        break;
+    case '0':                           /* \0NNN, up to three octal digits */
+        if (*s < '0' || *s > '7') {
+            c = 0;
+            break;
+        }
+        c = *s++;
+        /* fall through */
+    case '1': case '2': case '3': case '4': case '5': case '6': case '7':
+        c -= '0';                       /* \NNN, up to three octal digits */
+        for (n = 1; n < 3 && *s >= '0' && *s <= '7'; n++) {
+            c = c * 8 + (*s++ - '0');
+        }
+        break;
+    default:                            /* not an escape, print it as is */
+        putchar('\\');
+        break;
+    }
+    putchar(c);
+    *sp = s;
+    return 0;
+}
+
+/*
+ * do_cache - Execute the builtin cache command
+ *
+ *    cache [-i file]... cmd [arg ...]   run cmd, or replay its last run
+ *    cache -s                           print the hit and miss counters
+ *
+ * A run is identified by the working directory, the environment cmd
+ * gets (NAME=value words in front of cache included), argv and the size
+ * and mtime of every -i input file. If the store holds an entry for it, the
+ * stored stdout is copied out and its exit status becomes laststatus
+ * without forking at all. Otherwise cmd runs as a foreground job with
+ * its stdout going into a new entry, which is printed when the job is
+ * done and kept if the job exited with a status below 126 (it was not
+ * killed and did exec). A job that is stopped is not cached, and the
+ * rest of its output is lost.
+ *
+ * The store is the directory $TSH_CACHE (default $HOME/.tsh_cache).
+ * Each entry is named by the hex key, holds a header with the exit
+ * status and then the output. Its mtime is refreshed on every hit, and
+ * the least recently used entries are removed once the store grows
+ * past $TSH_CACHE_MAX bytes (default 64M, K/M/G suffixes allowed).
+ */
+void do_cache(char **argv, int bg, char **envp)
+{
+    char *inputs[MAXARGS];              /* -i files */
+    char dir[MAXLINE], path[MAXLINE + 32], tmp[MAXLINE + 64]; /* Store, entry, entry being written */
+    char hdr[CACHEHDR + 1];             /* Entry header */
+    char line[MAXLINE];                 /* Command line of the job */
+    unsigned long long key;             /* Hash identifying the run */
+    struct event_t *ev;                 /* How the job ended */
+    struct redir_t redir;               /* Job stdout into the entry */
+    int i, fd, ninputs = 0;
+    pid_t pid;
+
+    if (argv[1] != NULL && !strcmp(argv[1], "-s")) {
+        printf("cache: %lu hits, %lu misses, %lu evictions\n",
+               cachehits, cachemisses, cacheevictions);
+        return;
+    }
+    for (i = 1; argv[i] != NULL && !strcmp(argv[i], "-i") && argv[i + 1] != NULL; i += 2) {
+        if (ninputs < MAXARGS) {
+            inputs[ninputs++] = argv[i + 1];
+        }
+    }
+    if (argv[i] == NULL || argv[i][0] == '-') {
+        printf("%s: usage: cache [-i file]... cmd [arg ...] | cache -s\n", argv[0]);
+        laststatus = 2;
+        return;
+    }
+    joinwords(line, argv, bg);          /* command line of the job */
+    if (bg) {                           /* nothing to replay into, just run it */
+        launch(argv + i, 1, line, NULL, NULL, envp);
+        return;
+    }
+    if (cachekey(argv + i, envp, inputs, ninputs, &key) < 0 || cachedir(dir) < 0) {
+        laststatus = 1;
+        return;
+    }
+    snprintf(path, sizeof(path), "%s/%016llx", dir, key);
+
+    /* hit: replay the entry */
+    if ((fd = open(path, O_RDONLY | O_CLOEXEC)) >= 0) {
+        if (read(fd, hdr, CACHEHDR) == CACHEHDR && !strncmp(hdr, "tsh-cache ", 10)) {
+            cachehits++;
+            futimens(fd, NULL);         /* most recently used */
+            catfd(fd);
+            close(fd);
+            laststatus = atoi(hdr + 10);
+            return;
+        }
+        close(fd);                      /* not ours or torn, run it again */
+    }
+
+    /* miss: run it with stdout going into a new entry */
+    cachemisses++;
+    snprintf(tmp, sizeof(tmp), "%s.%d.tmp", path, (int)getpid());
+    if ((fd = open(tmp, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600)) < 0) {
+        printf("cache: %s: %s\n", tmp, strerror(errno));
+        laststatus = 1;
+        return;
+    }
+    if (write(fd, "tsh-cache 000\n", CACHEHDR) != CACHEHDR) {
+        printf("cache: %s: %s\n", tmp, strerror(errno));
+        close(fd);
+        unlink(tmp);
+        laststatus = 1;
+        return;
+    }
+    noredirs(&redir);
+    addredir(&redir, STDOUT_FILENO, fd, 0); /* fd is closed here, not by closeredirs() */
+    pid = launch(argv + i, 0, line, NULL, &redir, envp);
+
+    ev = findevent(pid);
+    if (ev != NULL && ev->stopped) {
+        printf("cache: job stopped, its output will not be cached\n");
+        close(fd);
+        unlink(tmp);
+        return;
+    }
+    lseek(fd, CACHEHDR, SEEK_SET);
+    catfd(fd);
+    if (ev != NULL && ev->status < 126) { /* not killed, and cmd could be run */
+        snprintf(hdr, sizeof(hdr), "tsh-cache %03d\n", (unsigned char)ev->status);
+        if (pwrite(fd, hdr, CACHEHDR, 0) == CACHEHDR && rename(tmp, path) == 0) {
+            close(fd);
+            cacheevict(dir);
+            return;
+        }
+    }
+    close(fd);
+    unlink(tmp);
+    return;
+}
+
+/*
+ * cachedir - Put the path of the cache store into dir, creating the
+ *    directory if needed. Returns 0 on success, -1 after reporting.
+ */
+int cachedir(char *dir)
+{
+    char *env;
+
+    if ((env = getenv("TSH_CACHE")) != NULL && *env) {
+        snprintf(dir, MAXLINE, "%s", env);
+    } else if ((env = getenv("HOME")) != NULL && *env) {
+        snprintf(dir, MAXLINE, "%s/.tsh_cache", env);
+    } else {
+        snprintf(dir, MAXLINE, "/tmp/tsh_cache.%d", (int)getuid());
+    }
+    if (mkdir(dir, 0700) < 0 && errno != EEXIST) {
+        printf("cache: %s: %s\n", dir, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * cachekey - Hash the working directory, cmd, its environment envp and
+ *    the size and mtime of each input into *key. Returns -1 after
+ *    reporting a missing input.
+ */
+int cachekey(char **cmd, char **envp, char **inputs, int ninputs, unsigned long long *key)
+{
+    unsigned long long h = 14695981039346656037ULL; /* FNV-1a offset basis */
+    char cwd[MAXLINE];
+    struct stat st;
+    int i;
+
+    if (getcwd(cwd, sizeof(cwd)) == NULL) {
+        cwd[0] = '\0';
+    }
+    h = fnv1a(h, cwd, strlen(cwd) + 1);
+    for (i = 0; cmd[i] != NULL; i++) {
+        h = fnv1a(h, cmd[i], strlen(cmd[i]) + 1);
+    }
+    h = fnv1a(h, "", 1);                /* argv ends here */
+    for (i = 0; envp[i] != NULL; i++) {
+        h = fnv1a(h, envp[i], strlen(envp[i]) + 1);
+    }
+    for (i = 0; i < ninputs; i++) {
+        if (stat(inputs[i], &st) < 0) {
+            printf("cache: %s: %s\n", inputs[i], strerror(errno));
+            return -1;
+        }
+        h = fnv1a(h, inputs[i], strlen(inputs[i]) + 1);
+        h = fnv1a(h, &st.st_size, sizeof(st.st_size));
+        h = fnv1a(h, &st.st_mtim, sizeof(st.st_mtim));
+    }
+    *key = h;
+    return 0;
+}
+
+/* fnv1a - Continue the 64-bit FNV-1a hash h over n bytes at p */
+unsigned long long fnv1a(unsigned long long h, const void *p, size_t n)
+{
+    const unsigned char *b = p;
+
+    while (n-- > 0) {
+        h = (h ^ *b++) * 1099511628211ULL;
+    }
+    return h;
+}
+
+/* cacheent_t - An entry of the store, for eviction */
+struct cacheent_t {
+    char name[32];
+    off_t size;
+    struct timespec mtime;
+};
+
+/* entcmp - qsort() comparison putting the least recently used entry first */
+static int entcmp(const void *a, const void *b)
+{
+    const struct cacheent_t *x = a, *y = b;
+
+    if (x->mtime.tv_sec != y->mtime.tv_sec) {
+        return (x->mtime.tv_sec < y->mtime.tv_sec) ? -1 : 1;
+    }
+    return (x->mtime.tv_nsec < y->mtime.tv_nsec) ? -1 : (x->mtime.tv_nsec > y->mtime.tv_nsec);
+}
+
+/*
+ * cacheevict - Remove the least recently used entries of the store in
+ *    dir until it is within $TSH_CACHE_MAX bytes
+ */
+void cacheevict(char *dir)
+{
+    struct cacheent_t *ents = NULL, *e; /* Entries of the store */
+    struct dirent *d;
+    struct stat st;
+    DIR *dp;
+    off_t total = 0, max = CACHEMAX;
+    int n = 0, room = 0, i, dfd;
+    char *env;
+
+    if ((env = getenv("TSH_CACHE_MAX")) != NULL && parsesize(env) > 0) {
+        max = parsesize(env);
+    }
+    if ((dp = opendir(dir)) == NULL) {
+        return;
+    }
+    dfd = dirfd(dp);
+    while ((d = readdir(dp)) != NULL) {
+        if (strlen(d->d_name) != 16 || strspn(d->d_name, "0123456789abcdef") != 16
+                || fstatat(dfd, d->d_name, &st, 0) < 0) {
+            continue;                   /* only complete entries */
+        }
+        if (n == room) {
+            room = room ? 2 * room : 64;
+            if ((e = realloc(ents, room * sizeof(*ents))) == NULL) {
+                break;
+            }
+            ents = e;
+        }
+        strcpy(ents[n].name, d->d_name);
+        ents[n].size = st.st_size;
+        ents[n].mtime = st.st_mtim;
+        total += st.st_size;
+        n++;
+    }
+
+    if (total > max) {
+        qsort(ents, n, sizeof(*ents), entcmp);
+        for (i = 0; i < n && total > max; i++) {
+            if (unlinkat(dfd, ents[i].name, 0) == 0) {
+                total -= ents[i].size;
+                cacheevictions++;
+            }
+        }
+    }
+    closedir(dp);
+    free(ents);
+}
+
+/* catfd - Copy the rest of the file open on fd to stdout */
+void catfd(int fd)
+{
+    static char buf[65536];
+    ssize_t n, w, off;
+
+    fflush(stdout);
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        for (off = 0; off < n; off += w) {
+            if ((w = write(STDOUT_FILENO, buf + off, n - off)) < 0) {
+                return;
+            }
+        }
+    }
+}
+
+/*
+ * parselimits - Parse a leading limit command into lim
+ *
+ *    limit [cpu=<secs>] [as=<bytes>] [nofile=<n>] [timeout=<secs>] cmd ...
+ *
+ * as= takes a K, M or G suffix and timeout= may be fractional. The
+ * limit words are removed from argv, leaving the command to launch.
+ * Returns 0 on success (also when there is no limit command) and -1
+ * after reporting a bad option.
+ */
+int parselimits(char **argv, struct limits_t *lim)
+{
+    int i, n;                           /* Index of the word being parsed, words to remove */
+    char *val, *end;                    /* Value of the option, end of its number */
+    rlim_t *rlim;                       /* rlimit field the option sets */
+    double secs;                        /* Timeout in seconds */
+
+    lim->cpu = lim->as = lim->nofile = RLIM_INFINITY;
+    lim->timeout = 0;
+    if (strcmp(argv[0], "limit")) {
+        return 0;
+    }
+
+    for (i = 1; argv[i] != NULL && (val = strchr(argv[i], '=')) != NULL; i++) {
+        val++;
+        if (!strncmp(argv[i], "cpu=", 4)) {
+            rlim = &lim->cpu;
+        } else if (!strncmp(argv[i], "as=", 3)) {
+            rlim = &lim->as;
+        } else if (!strncmp(argv[i], "nofile=", 7)) {
+            rlim = &lim->nofile;
+        } else if (!strncmp(argv[i], "timeout=", 8)) {
+            secs = strtod(val, &end);
+            if (*val == '\0' || *end != '\0' || secs <= 0) {
+                printf("limit: bad timeout %s\n", val);
+                return -1;
+            }
+            lim->timeout = (long)(secs * 1000);
+            if (lim->timeout == 0) {
+                lim->timeout = 1;
+            }
+            continue;
+        } else {
+            printf("limit: unknown limit %s\n", argv[i]);
+            return -1;
+        }
+        if ((*rlim = parsesize(val)) == 0) {
+            printf("limit: bad value %s\n", argv[i]);
+            return -1;
+        }
+    }
+    if (argv[i] == NULL) {
+        printf("limit command requires a command to run\n");
+        return -1;
+    }
+
+    /* shift the limited command down over the limit words */
+    n = i;
+    for (i = 0; argv[i + n] != NULL; i++) {
+        argv[i] = argv[i + n];
+    }
+    argv[i] = NULL;
+    return 0;
+}
+
+/*
+ * parsesize - Parse a positive number with an optional K, M or G
+ *    suffix. Returns 0 if s is not such a number.
+ */
+rlim_t parsesize(char *s)
+{
+    char *end;                          /* First character after the digits */
+    unsigned long long v;               /* Value before the suffix */
+
+    if (!isdigit((unsigned char)*s)) {
+        return 0;
+    }
+    v = strtoull(s, &end, 10);
+    switch (*end) {
+    case 'G': case 'g':
+        v <<= 10;
+        /* fall through */
+    case 'M': case 'm':
+        v <<= 10;
+        /* fall through */
+    case 'K': case 'k':
+        v <<= 10;
+        end++;
+        break;
+    }
+    return (*end == '\0') ? (rlim_t)v : 0;
+}
+
+/*
+ * setlimits - Apply the resource limits in lim to the calling process.
+ *    Called in the child between fork and exec. A soft limit is capped
+ *    at the inherited hard limit, which an unprivileged process cannot
+ *    raise.
+ */
+void setlimits(struct limits_t *lim)
+{
+    int resources[] = { RLIMIT_CPU, RLIMIT_AS, RLIMIT_NOFILE };
+    rlim_t values[] = { lim->cpu, lim->as, lim->nofile };
+    struct rlimit rl;                   /* Inherited and then new limits */
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        if (values[i] == RLIM_INFINITY || getrlimit(resources[i], &rl) < 0) {
+            continue;
+        }
+        rl.rlim_cur = (values[i] < rl.rlim_max) ? values[i] : rl.rlim_max;
+        if (setrlimit(resources[i], &rl) < 0) {
+            printf("limit: setrlimit: %s\n", strerror(errno));
+        }
+    }
+}
+
+/*
+ * noredirs - Set r to no redirections
+ */
+void noredirs(struct redir_t *r)
+{
+    r->n = 0;
+}
+
+/*
+ * parseredirs - Take the redirections out of argv and open their files
+ *    into r. Each operator is a word of its own followed by the file:
+ *    < file, > file, >> file and >!size file, which is > file with size
+ *    bytes preallocated. 2>&1 points stderr at the current stdout, so
+ *    like in sh the redirections take effect in the order given. Only
+ *    operators as parseline() stores them count, so a quoted '>' is an
+ *    ordinary word. Returns -1 with nothing left open if a file is
+ *    missing or cannot be opened.
+ */
+int parseredirs(char **argv, struct redir_t *r)
+{
+    int i, n = 0;                       /* Word being parsed, words kept */
+    char *op;                           /* Current operator */
+    off_t size;                         /* Preallocation of >! */
+    int flags;
+
+    noredirs(r);
+    for (i = 0; argv[i] != NULL; i++) {
+        op = argv[i];
+        if (op == operrout) {
+            if (addredir(r, STDERR_FILENO, STDOUT_FILENO, 0) < 0) {
+                closeredirs(r);
+                return -1;
+            }
+            continue;
+        }
+        size = 0;
+        if (op == opin) {
+            flags = O_RDONLY;
+        } else if (op == opout) {
+            flags = O_WRONLY | O_CREAT | O_TRUNC;
+        } else if (op == opappend) {
+            flags = O_WRONLY | O_CREAT | O_APPEND;
+        } else if (op == opsized && argv[i + 1] != NULL) {
+            size = parsesize(argv[++i]); /* checked by parseline() */
+            flags = O_WRONLY | O_CREAT | O_TRUNC;
+        } else {
+            argv[n++] = op;             /* not a redirection */
+            continue;
+        }
+        if (argv[++i] == NULL) {
+            printf("%s: missing file name\n", op);
+            closeredirs(r);
+            return -1;
+        }
+        if (openredir(r, (op == opin) ? 0 : 1, argv[i], flags, size) < 0) {
+            closeredirs(r);
+            return -1;
+        }
+    }
+    argv[n] = NULL;
+    return 0;
+}
+
+/*
+ * openredir - Open path with flags as the target descriptor of r,
+ *    after the redirections already in r. A nonzero size is
+ *    allocated up front without changing the file size, so a big
+ *    writer gets contiguous extents; filesystems that cannot do that
+ *    simply skip it. Returns -1 if path cannot be opened.
+ */
+int openredir(struct redir_t *r, int target, char *path, int flags, off_t size)
+{
+    int fd;
+
+    if ((fd = open(path, flags | O_CLOEXEC, 0666)) < 0) {
+        printf("%s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    if (size > 0) {
+        fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, size);
+    }
+    if (addredir(r, target, fd, 1) < 0) {
+        close(fd);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * addredir - Append to r the op that points target at fd; opened says
+ *    closeredirs() owns fd. Returns -1 if r is full.
+ */
+int addredir(struct redir_t *r, int target, int fd, int opened)
+{
+    if (r->n == MAXREDIRS) {
+        printf("Too many redirections\n");
+        return -1;
+    }
+    r->ops[r->n].target = target;
+    r->ops[r->n].fd = fd;
+    r->ops[r->n].opened = opened;
+    r->n++;
+    return 0;
+}
+
+/* redirected - Return true if r redirects the target descriptor */
+int redirected(struct redir_t *r, int target)
+{
+    int i;
+
+    for (i = 0; i < r->n; i++) {
+        if (r->ops[i].target == target) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * setredirs - Apply the ops of r to stdin, stdout and stderr in order.
+ *    In the shell itself, around a builtin, saved gets what they were
+ *    before for restoreio(); in a child saved is NULL.
+ */
+void setredirs(struct redir_t *r, int *saved)
+{
+    int i;
+
+    if (saved != NULL) {
+        fflush(stdout);
+        for (i = 0; i < 3; i++) {
+            saved[i] = redirected(r, i) ? fcntl(i, F_DUPFD_CLOEXEC, 10) : -1;
+        }
+    }
+    for (i = 0; i < r->n; i++) {
+        dup2(r->ops[i].fd, r->ops[i].target);
+    }
+}
+
+/*
+ * restoreio - Give the shell back the descriptors that setredirs()
+ *    saved
+ */
+void restoreio(int *saved)
+{
+    int i;
+
+    fflush(stdout);
+    for (i = 0; i < 3; i++) {
+        if (saved[i] >= 0) {
+            dup2(saved[i], i);
+            close(saved[i]);
+        }
+    }
+}
+
+/* closeredirs - Close the files of r */
+void closeredirs(struct redir_t *r)
+{
+    int i;
+
+    for (i = 0; i < r->n; i++) {
+        if (r->ops[i].opened) {
+            close(r->ops[i].fd);
+        }
+    }
+    noredirs(r);
+}
+
+/*****************
+ * Signal handlers
+ *****************/
+
+/*
+ * sigchld_handler - The kernel sends a SIGCHLD to the shell whenever
+ *     a child job terminates (becomes a zombie), or stops because it
+ *     received a SIGSTOP or SIGTSTP signal. The handler reaps all
+ *     available zombie children, but doesn't wait for any other
+ *     currently running children to terminate.
+ * 
+ *  we are using asprintf() to build our 
+ */
+void sigchld_handler(int sig)
+{
+    pid_t pid;              /* Process id of terminated child */
+    int childStatus;        /* Status of the child */
+    int old_errno = errno;  /* Back up errno */
+
+    /* no wrapper made for waitpid since it always eventually returns -1 when used in a while loop*/
+    while ((pid = waitpid(-1, &childStatus, WNOHANG|WUNTRACED)) > 0) {
+        if (WIFEXITED(childStatus)) {           /* Child terminated normally */ 
+            addevent(pid, WEXITSTATUS(childStatus), 0);
+            deletejob(jobs, pid);
+            reaped = 1;                         /* its deadlines are pruned outside the handler */
+        }
+        else if (WIFSTOPPED(childStatus)) {     /* Child stopped */ 
+            addevent(pid, 128 + WSTOPSIG(childStatus), 1);
+            getjobpid(jobs, pid)->state = ST;   /* Set job state to stopped */
+            /* 
+             * To print async signal safe we call sio_puts seperately for each 
+             * string between a variable and the variables themselves,
+             * We use sio_putl to print the variables after we cast them to long
+             */
+            Sio_puts("Job [");
+            Sio_putl((long)pid2jid(pid));
+            Sio_puts("] (");
+            Sio_putl((long)pid);
+            Sio_puts(") stopped by signal ");
+            Sio_putl((long)WSTOPSIG(childStatus));
+            Sio_puts("\n");
+        }
+        else if (WIFSIGNALED(childStatus)) {     /* Child terminated by uncaught signal */
+
+            Sio_puts("Job [");
+            Sio_putl((long)pid2jid(pid));
+            Sio_puts("] (");
+            Sio_putl((long)pid);
+            Sio_puts(") terminated by signal ");
+            Sio_putl((long)WTERMSIG(childStatus));
+            Sio_puts("\n");
+            addevent(pid, 128 + WTERMSIG(childStatus), 0);
+            deletejob(jobs, pid);
+            reaped = 1;
+        }
+        else {                                  /* Child terminated by unusual signal */
+            Sio_puts("child terminated abnormallly\n");
+        }
+    }
+    if (pid < 0 && errno != ECHILD) {           /* waitpid() failed with error other than ECHILD */
+        unix_error("Waitpid error");            /*   since the loop does not stop until waitpid() returns an error state */
+    }
+    errno = old_errno;                          /* Restore errno to it's previous state so that is is unalyered for the previus process */
+    return;
+}
+
+/*
+ * sigint_handler - The kernel sends a SIGINT to the shell whenver the
+ *    user types ctrl-c at the keyboard.  Catch it and send it along
+ *    to the foreground job.
+ */
+void sigint_handler(int sig)
+{
+    std_sig_handler(sig);
+    return;
+}
+
+/*
+ * sigtstp_handler - The kernel sends a SIGTSTP to the shell whenever
+ *     the user types ctrl-z at the keyboard. Catch it and suspend the
+ *     foreground job by sending it a SIGTSTP.
+ */
+void sigtstp_handler(int sig)
+{
+    std_sig_handler(sig);
+    return;   
+}
+
+/*
+ * Standard sig handler so the other handlers aren't depending on each other
+ */
+void std_sig_handler(int sig)
+{
+    int old_errno = errno;      /* Backing up errno so that is can be retored for the previous process incase kill() modifies it */
+    pid_t pid = fgpid(jobs);    /* Get the pid of the forground process */
+    if ((pid > 0) && (pid2jid(pid) > 0)) {
+        kill(-pid, sig);        /* Send a kill command with the passed signal parameter */
+    } else if (sig == SIGINT) {
+        interrupted = 1;        /* No foreground job, ctrl-c is for the shell (e.g. wait) */
+    }
+    errno = old_errno;
+    return;
+}
+/*
+ * sigalrm_handler - The kernel sends a SIGALRM to the shell when the
+ *     earliest job deadline has passed. Sends SIGTERM to the process
+ *     group of every job that is past its deadline and schedules a
+ *     SIGKILL KILLGRACE ms later in case the job ignores it. The death
+ *     itself is reported by sigchld_handler like any other.
+ */
+void sigalrm_handler(int sig)
+{
+    int old_errno = errno;      /* Back up errno */
+    sigset_t mask, prev;        /* SIGCHLD is blocked while the job list is read */
+    struct deadline_t d;        /* Deadline that has passed */
+    struct job_t *job;          /* Job the deadline belongs to */
+    long now = nowms();
+
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &mask, &prev);
+    while (ndeadlines > 0 && deadlines[0].when <= now) {
+        d = popdeadline();
+        job = getjobpid(jobs, d.pid);
+        if (job == NULL || job->jid != d.jid) {
+            continue;           /* the job finished in time */
+        }
+        kill(-d.pid, d.sig);
+        if (d.sig == SIGTERM) {
+            if (job->state == ST) {
+                kill(-d.pid, SIGCONT); /* let a stopped job act on the SIGTERM */
+            }
+            if (adddeadline(now + KILLGRACE, d.pid, d.jid, SIGKILL) < 0) {
+                Sio_puts("limit: no room for the grace period, killing at once\n");
+                kill(-d.pid, SIGKILL);
+            }
+        }
+    }
+    armdeadline();
+    sigprocmask(SIG_SETMASK, &prev, NULL);
+    errno = old_errno;
+    return;
+}
+
+/*********************
+ * End signal handlers
+ *********************/
+
+/***********************************************
+ * Helper routines that manipulate the job list
+ **********************************************/
+
+/* clearjob - Clear the entries in a job struct */
+void clearjob(struct job_t *job)
+{
+    job->pid = 0;
+    job->jid = 0;
+    job->state = UNDEF;
+    job->cmdline[0] = '\0';
+}
+
+/* initjobs - Initialize the job list */
+void initjobs(struct job_t *jobs)
+{
+    int i;
+
+    for (i = 0; i < MAXJOBS; i++) {
+        clearjob(&jobs[i]);
+    }
+}
+
+/* maxjid - Returns largest allocated job ID */
+int maxjid(struct job_t *jobs)
+{
+    int i, max=0;
+
+    for (i = 0; i < MAXJOBS; i++) {
+        if (jobs[i].jid > max) {
+            max = jobs[i].jid;
+        }
+    }
+    return max;
+}
+
+/* addjob - Add a job to the job list */
+int addjob(struct job_t *jobs, pid_t pid, int state, char *cmdline)
+{
+    int i;
+    if (pid < 1) {
+        return 0;
+    }
+    for (i = 0; i < MAXJOBS; i++) {
+        if (jobs[i].pid == 0) {
+            jobs[i].pid = pid;
+            jobs[i].state = state;
+            jobs[i].jid = nextjid++;
+            if (nextjid > MAXJOBS)
+                nextjid = 1;
+            strcpy(jobs[i].cmdline, cmdline);
+            if (verbose) {
+                printf("Added job [%d] %d %s\n", jobs[i].jid, jobs[i].pid, jobs[i].cmdline);
+            }
+            return 1;
+        }
+    }
+    printf("Tried to create too many jobs\n");
+    return 0;
+}
+
+/* deletejob - Delete a job whose PID=pid from the job list */
+int deletejob(struct job_t *jobs, pid_t pid)
+{
+    int i;
+
+    if (pid < 1) {
+        return 0;
+    }
+
+    for (i = 0; i < MAXJOBS; i++) {
+        if (jobs[i].pid == pid) {
+            clearjob(&jobs[i]);
+            nextjid = maxjid(jobs)+1;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* fgpid - Return PID of current foreground job, 0 if no such job */
+pid_t fgpid(struct job_t *jobs) {
+    int i;
+
+    for (i = 0; i < MAXJOBS; i++) {
+        if (jobs[i].state == FG) {
+            return jobs[i].pid;
+        }
+    }
+    return 0;
+}
+
+/* getjobpid  - Find a job (by PID) on the job list */
+struct job_t *getjobpid(struct job_t *jobs, pid_t pid) {
+    int i;
+
+    if (pid < 1) {
+        return NULL;
+    }
+    for (i = 0; i < MAXJOBS; i++) {
+        if (jobs[i].pid == pid) {
+            return &jobs[i];
+        }
+    }
+    return NULL;
+}
+
+/* getjobjid  - Find a job (by JID) on the job list */
+struct job_t *getjobjid(struct job_t *jobs, int jid)
+{
+    int i;
+
+    if (jid < 1) {
+        return NULL;
+    }
+    for (i = 0; i < MAXJOBS; i++) {
+        if (jobs[i].jid == jid) {
+            return &jobs[i];
+        }
+    }
+    return NULL;
+}
+
+/* pid2jid - Map process ID to job ID */
+int pid2jid(pid_t pid)
+{
+    int i;
+
+    if (pid < 1) {
+        return 0;
+    }
+    for (i = 0; i < MAXJOBS; i++) {
+        if (jobs[i].pid == pid) {
+            return jobs[i].jid;
+        }
+    }
+    return 0;
+}
+
+/* listjobs - Print the job list */
+void listjobs(struct job_t *jobs)
+{
+    int i;
+
+    for (i = 0; i < MAXJOBS; i++) {
+        if (jobs[i].pid != 0) {
+            printf("[%d] (%d) ", jobs[i].jid, jobs[i].pid);
+            switch (jobs[i].state) {
+            case BG:
+                printf("Running ");
+                break;
+            case FG:
+                printf("Foreground ");
+                break;
+            case ST:
+                printf("Stopped ");
+                break;
+            default:
+                printf("listjobs: Internal error: job[%d].state=%d ",
+                       i, jobs[i].state);
+            }
+            printf("%s", jobs[i].cmdline);
+        }
+    }
+}
+/* runningjobs - Return the number of jobs that are not stopped */
+int runningjobs(struct job_t *jobs)
+{
+    int i, n = 0;
+
+    for (i = 0; i < MAXJOBS; i++) {
+        if (jobs[i].state == FG || jobs[i].state == BG) {
+            n++;
+        }
+    }
+    return n;
+}
+
+/* addevent - Record that job pid stopped or terminated (called from sigchld_handler) */
+void addevent(pid_t pid, int status, int stopped)
+{
+    struct event_t *ev = &events[nevents % MAXEVENTS];
+
+    ev->pid = pid;
+    ev->jid = pid2jid(pid);
+    ev->status = status;
+    ev->stopped = stopped;
+    ev->bg = getjobpid(jobs, pid) != NULL && getjobpid(jobs, pid)->state != FG;
+    nevents++;
+}
+
+/* findevent - Find the latest remembered event of job pid */
+struct event_t *findevent(pid_t pid)
+{
+    unsigned long i;
+
+    for (i = nevents; i > 0 && nevents - i < MAXEVENTS; i--) {
+        if (events[(i - 1) % MAXEVENTS].pid == pid) {
+            return &events[(i - 1) % MAXEVENTS];
+        }
+    }
+    return NULL;
+}
+/*
+ * findeventarg - Find the latest termination of the job named by a PID
+ *    or %jobid argument, if that job is no longer in the job list. A
+ *    %jobid only names jobs whose jid was shown, not foreground ones.
+ */
+struct event_t *findeventarg(char *arg)
+{
+    struct event_t *ev;
+    unsigned long i;
+    int jid = 0;
+    pid_t pid = 0;
+
+    if (arg[0] == '%') {
+        jid = atoi(arg + 1);
+    } else {
+        pid = atoi(arg);
+    }
+    if ((jid <= 0 && pid <= 0) || (jid > 0 && getjobjid(jobs, jid) != NULL)
+                               || (pid > 0 && getjobpid(jobs, pid) != NULL)) {
+        return NULL;
+    }
+    for (i = nevents; i > 0 && nevents - i < MAXEVENTS; i--) {
+        ev = &events[(i - 1) % MAXEVENTS];
+        if (!ev->stopped && ((jid > 0 && ev->bg && ev->jid == jid) || (pid > 0 && ev->pid == pid))) {
+            return ev;
+        }
+    }
+    return NULL;
+}
+/******************************
+ * end job list helper routines
+ ******************************/
+
+
+/*************************************************************
+ * Helper routines for the command arena and glob expansion.
+ * Everything parseline() builds lives in the arena, which is
+ * emptied at the start of each command line. Directory listings
+ * outlive it in dircache and are reread only when the directory
+ * has changed.
+ ************************************************************/
+
+/* arenaalloc - Allocate n bytes from the command arena */
+void *arenaalloc(size_t n)
+{
+    struct arena_t *a;
+    size_t size;
+
+    n = (n + 15) & ~(size_t)15;         /* keep every allocation aligned */
+    if (arena == NULL || arena->size - arena->used < n) {
+        size = (n > ARENACHUNK) ? n : ARENACHUNK;
+        if ((a = malloc(sizeof(struct arena_t) + size)) == NULL) {
+            unix_error("arenaalloc error");
+        }
+        a->next = arena;
+        a->size = size;
+        a->used = 0;
+        arena = a;
+    }
+    arena->used += n;
+    return arena->data + arena->used - n;
+}
+
+/* arenadup - Copy the n bytes at s into the arena as a string */
+char *arenadup(const char *s, size_t n)
+{
+    char *d = arenaalloc(n + 1);
+
+    memcpy(d, s, n);
+    d[n] = '\0';
+    return d;
+}
+
+/* arenareset - Free everything in the arena but its first block */
+void arenareset(void)
+{
+    struct arena_t *a;
+
+    while (arena != NULL && arena->next != NULL) {
+        a = arena;
+        arena = arena->next;
+        free(a);
+    }
+    if (arena != NULL) {
+        arena->used = 0;
+    }
+}
+
+/* addarg - Append word to av, doubling its argv when it is full */
+void addarg(struct argvec_t *av, char *word)
+{
+    char **argv;
+
+    if (av->argc == av->max) {
+        argv = arenaalloc((2 * av->max + 1) * sizeof(char *));
+        memcpy(argv, av->argv, av->argc * sizeof(char *));
+        av->argv = argv;
+        av->max *= 2;
+    }
+    av->argv[av->argc++] = word;
+}
+
+/*
+ * globword - Append the paths matching pattern to av, in sorted order.
+ *    Returns the number of matches; av is unchanged if there are none.
+ */
+int globword(struct argvec_t *av, char *pattern)
+{
+    int argc = av->argc;
+    char *pat = arenadup(pattern, strlen(pattern)); /* globdir() cuts it up */
+
+    if (*pat == '/') {
+        globdir(av, "/", pat + 1);
+    } else {
+        globdir(av, "", pat);
+    }
+    return av->argc - argc;
+}
+
+/*
+ * globdir - Match the path pattern rest against the directory dir
+ *    ("" for the current one, else ending in '/') and append every
+ *    match to av. Components without wildcards are taken as they are;
+ *    the others are matched against the cached listing, starting at the
+ *    first name that could have the component's literal prefix.
+ */
+void globdir(struct argvec_t *av, char *dir, char *rest)
+{
+    struct dirlist_t *dl;               /* Listing of dir */
+    struct stat st;                     /* For checking a literal tail exists */
+    char *comp = rest, *slash;          /* Current component, the '/' after it */
+    char *path;                         /* dir joined with a match */
+    size_t dlen = strlen(dir), plen, nlen; /* Length of dir, of the literal prefix, of a match */
+    int lo, hi, mid;                    /* Binary search of the listing */
+    int type;                           /* d_type of a matching name */
+
+    /* take the components without wildcards as they are */
+    while ((slash = strchr(comp, '/')) != NULL && strpbrk(comp, "*?[") > slash) {
+        comp = slash + 1;
+    }
+    if (strpbrk(comp, "*?[") == NULL) { /* nothing left to match */
+        path = arenaalloc(dlen + strlen(rest) + 1);
+        strcpy(path, dir);
+        strcat(path, rest);
+        if (lstat(path, &st) == 0) {
+            addarg(av, path);
+        }
+        return;
+    }
+    if (comp != rest) {                 /* descend to the literal part first */
+        path = arenaalloc(dlen + (comp - rest) + 1);
+        memcpy(path, dir, dlen);
+        memcpy(path + dlen, rest, comp - rest);
+        path[dlen + (comp - rest)] = '\0';
+        globdir(av, path, comp);
+        return;
+    }
+
+    if ((slash = strchr(comp, '/')) != NULL) {
+        *slash = '\0';                  /* comp is now one component */
+    }
+    if ((dl = listdir(dir)) == NULL) {
+        if (slash != NULL) {
+            *slash = '/';
+        }
+        return;
+    }
+
+    /* names before the first that starts with the literal prefix cannot match */
+    plen = strcspn(comp, "*?[\\");
+    for (lo = 0, hi = dl->n; lo < hi; ) {
+        mid = (lo + hi) / 2;
+        if (strncmp(dl->names[mid], comp, plen) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    for (; lo < dl->n && !strncmp(dl->names[lo], comp, plen); lo++) {
+        if (fnmatch(comp, dl->names[lo], FNM_PERIOD) != 0) {
+            continue;
+        }
+        type = (unsigned char)dl->names[lo][-1];
+        if (slash != NULL && type != DT_DIR && type != DT_LNK && type != DT_UNKNOWN) {
+            continue;                   /* only directories have more components */
+        }
+        nlen = strlen(dl->names[lo]);
+        path = arenaalloc(dlen + nlen + 2);
+        memcpy(path, dir, dlen);
+        memcpy(path + dlen, dl->names[lo], nlen + 1);
+        if (slash == NULL) {
+            addarg(av, path);
+        } else {
+            strcat(path, "/");
+            globdir(av, path, slash + 1);
+        }
+    }
+    if (slash != NULL) {
+        *slash = '/';
+    }
+}
+
+/* namecmp - qsort() comparison of two names */
+static int namecmp(const void *a, const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/*
+ * listdir - Return the sorted listing of dir ("" for the current
+ *    directory), from dircache if the directory has not changed since
+ *    it was read (same device, inode and mtime), else read afresh with
+ *    getdents64(). Timestamps only move once per clock tick, so a
+ *    listing read in the tick its directory last changed is not
+ *    trusted again. Returns NULL if dir cannot be read.
+ */
+struct dirlist_t *listdir(char *dir)
+{
+    struct dirlist_t *dl;               /* Cache slot of dir */
+    struct stat st;                     /* Current identity and mtime of dir */
+    struct timespec now;                /* Tick of the clock timestamps come from */
+    unsigned long h = 5381;             /* djb2 hash of dir */
+    char *p, *name = (*dir) ? dir : ".";
+    int fd;
+
+    for (p = dir; *p; p++) {
+        h = h * 33 + (unsigned char)*p;
+    }
+    dl = &dircache[h % DIRCACHE];
+
+    if ((fd = open(name, O_RDONLY | O_DIRECTORY | O_CLOEXEC)) < 0) {
+        return NULL;
+    }
+    clock_gettime(CLOCK_REALTIME_COARSE, &now);
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return NULL;
+    }
+    if (dl->path != NULL && !strcmp(dl->path, dir) && dl->dev == st.st_dev
+            && dl->ino == st.st_ino && dl->mtime.tv_sec == st.st_mtim.tv_sec
+            && dl->mtime.tv_nsec == st.st_mtim.tv_nsec && !dl->racy) {
+        close(fd);
+        return dl;                      /* unchanged since we read it */
+    }
+
+    /* evict whatever held the slot */
+    free(dl->path);
+    free(dl->names);
+    free(dl->strings);
+    memset(dl, 0, sizeof(*dl));
+
+    if (readdirlist(fd, dl) < 0) {
+        close(fd);
+        return NULL;
+    }
+    close(fd);
+    dl->path = strdup(dir);
+    dl->dev = st.st_dev;
+    dl->ino = st.st_ino;
+    dl->mtime = st.st_mtim;
+    dl->racy = st.st_mtim.tv_sec > now.tv_sec
+               || (st.st_mtim.tv_sec == now.tv_sec && st.st_mtim.tv_nsec >= now.tv_nsec);
+    return dl;
+}
+
+/*
+ * readdirlist - Read all entries of the directory open on fd into dl
+ *    with getdents64() and sort them. Each name is stored right after
+ *    its d_type byte, so the type travels with the name through the
+ *    sort. Returns 0 on success, -1 on error.
+ */
+int readdirlist(int fd, struct dirlist_t *dl)
+{
+    struct dent64 {                     /* Record layout of getdents64() */
+        unsigned long long d_ino;
+        long long d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[];
+    } *d;
+    static char dents[DENTSBUF];        /* Raw records of one call */
+    char **names = NULL, *strings = NULL, *p; /* Names and their storage, grown as we go */
+    size_t nlen, slen = 0, smax = 0;    /* Bytes of strings used and allocated */
+    long n, off;                        /* Bytes from one call, offset of a record */
+    int count = 0, max = 0, i;
+
+    while ((n = syscall(SYS_getdents64, fd, dents, sizeof(dents))) > 0) {
+        for (off = 0; off < n; off += d->d_reclen) {
+            d = (struct dent64 *)(dents + off);
+            if (d->d_name[0] == '.' && (d->d_name[1] == '\0'
+                    || (d->d_name[1] == '.' && d->d_name[2] == '\0'))) {
+                continue;
+            }
+            nlen = strlen(d->d_name) + 2;
+            if (slen + nlen > smax) {
+                smax = (smax + nlen) * 2;
+                if ((p = realloc(strings, smax)) == NULL) {
+                    goto fail;
+                }
+                strings = p;
+            }
+            if (count == max) {
+                max = max ? 2 * max : 256;
+                if ((p = realloc(names, max * sizeof(char *))) == NULL) {
+                    goto fail;
+                }
+                names = (char **)p;
+            }
+            strings[slen] = d->d_type;
+            memcpy(strings + slen + 1, d->d_name, nlen - 1);
+            names[count++] = (char *)(slen + 1); /* an offset until strings stops moving */
+            slen += nlen;
+        }
+    }
+    if (n < 0) {
+        goto fail;
+    }
+
+    for (i = 0; i < count; i++) {
+        names[i] = strings + (size_t)names[i];
+    }
+    if (count > 0) {
+        qsort(names, count, sizeof(char *), namecmp); /* names is NULL for an empty directory */
+    }
+    dl->names = names;
+    dl->n = count;
+    dl->strings = strings;
+    return 0;
+
+ fail:
+    free(names);
+    free(strings);
+    return -1;
+}
+/*****************************************
+ * end arena and glob expansion routines
+ *****************************************/
+
+
+/************************************************************
+ * Helper routines for capturing background output (-o). Each
+ * background job writes into a pipe that the shell drains into
+ * a fixed-size ring whenever it waits: for input, in waitfg()
+ * and in wait. A foreground job's capture is written straight
+ * through to the terminal.
+ ************************************************************/
+
+/* initcaptures - Mark every capture slot free */
+void initcaptures(void)
+{
+    int i;
+
+    for (i = 0; i < MAXCAPTURES; i++) {
+        captures[i].fd = -1;
+        captures[i].pid = 0;
+        captures[i].seq = 0;
+    }
+}
+
+/*
+ * newcapture - Claim a capture slot for a new job and open its pipe,
+ *    whose write end is returned in *wfd. Takes a free slot, else the
+ *    oldest one whose job is gone and whose pipe is drained. Returns
+ *    NULL if every slot is still in use or the pipe fails.
+ */
+struct capture_t *newcapture(int *wfd)
+{
+    struct capture_t *c = NULL;
+    int i, p[2];
+
+    for (i = 0; i < MAXCAPTURES; i++) {
+        if (captures[i].fd < 0 && getjobpid(jobs, captures[i].pid) == NULL
+                && (c == NULL || captures[i].seq < c->seq)) {
+            c = &captures[i];
+        }
+    }
+    if (c == NULL || pipe2(p, O_CLOEXEC) < 0) {
+        return NULL;
+    }
+    fcntl(p[0], F_SETFL, O_NONBLOCK);
+    c->fd = p[0];
+    c->pid = 0;
+    c->jid = 0;
+    c->seq = ++captureseq;
+    c->total = c->shown = 0;
+    *wfd = p[1];
+    return c;
+}
+
+/* getcapture - Find the capture of job pid, NULL if it has none */
+struct capture_t *getcapture(pid_t pid)
+{
+    int i;
+
+    if (pid < 1) {
+        return NULL;
+    }
+    for (i = 0; i < MAXCAPTURES; i++) {
+        if (captures[i].pid == pid) {
+            return &captures[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * findcapture - Find the capture named by a PID or %jobid argument.
+ *    Job IDs are reused, so the latest job with the ID wins.
+ */
+struct capture_t *findcapture(char *arg)
+{
+    struct capture_t *c = NULL;
+    int i, id = atoi(arg + (arg[0] == '%'));
+
+    if (id <= 0) {
+        return NULL;
+    }
+    for (i = 0; i < MAXCAPTURES; i++) {
+        if (captures[i].pid != 0
+                && ((arg[0] == '%') ? captures[i].jid : captures[i].pid) == id
+                && (c == NULL || captures[i].seq > c->seq)) {
+            c = &captures[i];
+        }
+    }
+    return c;
+}
+
+/*
+ * drain - Read whatever the job has written into its ring. Closes the
+ *    pipe at EOF. The output of the foreground job is passed on to the
+ *    terminal.
+ */
+void drain(struct capture_t *c)
+{
+    char buf[65536];
+    ssize_t n;
+    size_t off, k;
+    char *p;
+
+    while (c->fd >= 0) {
+        if ((n = read(c->fd, buf, sizeof(buf))) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN) {
+                break;
+            }
+        }
+        if (n <= 0) {                   /* EOF, the job and its children are done with it */
+            close(c->fd);
+            c->fd = -1;
+            break;
+        }
+        p = buf;
+        if (n > CAPTURESIZE) {          /* only the tail can be kept anyway */
+            c->total += n - CAPTURESIZE;
+            p += n - CAPTURESIZE;
+            n = CAPTURESIZE;
+        }
+        while (n > 0) {
+            off = c->total % CAPTURESIZE;
+            k = ((size_t)n < CAPTURESIZE - off) ? (size_t)n : CAPTURESIZE - off;
+            memcpy(c->ring + off, p, k);
+            c->total += k;
+            p += k;
+            n -= k;
+        }
+    }
+    if (c->pid != 0 && c->pid == fgpid(jobs)) {
+        flushcapture(c, 0);
+    }
+}
+
+/*
+ * flushcapture - Write the ring of c to stdout: all of it if all is
+ *    set, else only what has not been shown yet. Says how much was lost
+ *    if the ring has wrapped past the start of that.
+ */
+void flushcapture(struct capture_t *c, int all)
+{
+    unsigned long long from = all ? 0 : c->shown;
+    size_t off, k;
+    ssize_t w;
+
+    fflush(stdout);
+    if (c->total - from > CAPTURESIZE) {
+        printf("[%d] (%d) %llu bytes of output dropped\n", c->jid, c->pid,
+               c->total - from - CAPTURESIZE);
+        fflush(stdout);
+        from = c->total - CAPTURESIZE;
+    }
+    while (from < c->total) {
+        off = from % CAPTURESIZE;
+        k = (c->total - from < CAPTURESIZE - off) ? c->total - from : CAPTURESIZE - off;
+        if ((w = write(STDOUT_FILENO, c->ring + off, k)) <= 0) {
+            break;
+        }
+        from += w;
+    }
+    c->shown = c->total;
+}
+
+/* capturefds - Fill fds with the open capture pipes, returns how many */
+int capturefds(struct pollfd *fds)
+{
+    int i, n = 0;
+
+    for (i = 0; i < MAXCAPTURES; i++) {
+        if (captures[i].fd >= 0) {
+            fds[n].fd = captures[i].fd;
+            fds[n].events = POLLIN;
+            fds[n++].revents = 0;
+        }
+    }
+    return n;
+}
+
+/* drainready - Drain every capture whose pipe poll() found ready */
+void drainready(struct pollfd *fds, int n)
+{
+    int i, j;
+
+    for (i = 0; i < n; i++) {
+        if (fds[i].revents == 0) {
+            continue;
+        }
+        for (j = 0; j < MAXCAPTURES; j++) {
+            if (captures[j].fd == fds[i].fd) {
+                drain(&captures[j]);
+            }
+        }
+    }
+}
+
+/* waitinput - Drain background output until stdin has input */
+void waitinput(void)
+{
+    struct pollfd fds[MAXCAPTURES + 1];
+    int n;
+
+    while (1) {
+        fds[0].fd = STDIN_FILENO;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        n = capturefds(fds + 1);
+        if (poll(fds, n + 1, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        drainready(fds + 1, n);
+        if (fds[0].revents) {
+            return;
+        }
+    }
+}
+
+/*
+ * waitevent - Sleep with the signal mask prev until a signal handler has
+ *    run, like sigsuspend(). With -o the capture pipes are drained while
+ *    sleeping, so a chatty job never blocks on a full pipe.
+ */
+void waitevent(sigset_t *prev)
+{
+    struct pollfd fds[MAXCAPTURES];
+    int n;
+
+    if (!capture || (n = capturefds(fds)) == 0) {
+        sigsuspend(prev);
+        return;
+    }
+    if (ppoll(fds, n, NULL, prev) > 0) {
+        drainready(fds, n);
+    }
+}
+/**************************
+ * end capture routines
+ **************************/
+
+
+/************************************************************
+ * Helper routines for command substitution. The command runs
+ * in a child copy of the shell, in a process group of its own
+ * that is the foreground job while the parent reads its output,
+ * so ctrl-c and ctrl-z reach it like any other foreground job.
+ ************************************************************/
+
+/*
+ * substend - Return the ) that closes the $( just before s, skipping
+ *    nested parentheses and single quotes, or NULL if there is none
+ */
+char *substend(char *s)
+{
+    int depth = 1;
+
+    for (; *s; s++) {
+        if (*s == '\'' && (s = strchr(s + 1, '\'')) == NULL) {
+            return NULL;
+        }
+        if (*s == '(') {
+            depth++;
+        }
+        else if (*s == ')' && --depth == 0) {
+            return s;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * substitute - Run the command line cmd and append the words of its
+ *    output (split at spaces, tabs and newlines, never globbed) to av.
+ *    The output is read in large chunks into a buffer that doubles as
+ *    needed, and split in place once it has been copied to the arena.
+ *    Returns -1 if the command was stopped or killed by ctrl-c, else 0.
+ */
+int substitute(struct argvec_t *av, char *cmd)
+{
+    char line[MAXLINE];                 /* cmd as a command line, also the job's */
+    sigset_t mask, prev;                /* Mask for SIGCHLD and SIGALRM, and backup */
+    char *out = NULL, *p;               /* Output read so far */
+    size_t len = 0, max = 0;            /* Bytes of out used and allocated */
+    ssize_t n;
+    struct event_t *ev;                 /* How the command ended */
+    pid_t pid;
+    int fd[2];
+
+    snprintf(line, sizeof(line), "%s\n", cmd);
+    if (pipe2(fd, O_CLOEXEC) < 0) {
+        unix_error("pipe error");
+    }
+    Sigemptyset(&mask);
+    Sigaddset(&mask, SIGCHLD);
+    Sigaddset(&mask, SIGALRM);
+    Sigprocmask(SIG_BLOCK, &mask, &prev);
+    fflush(stdout);
+    if ((pid = Fork()) == 0) {
+        Setpgid(0, 0);
+        dup2(fd[1], STDOUT_FILENO);
+        close(fd[0]);
+        close(fd[1]);
+        initjobs(jobs);                 /* the jobs of the parent are not ours */
+        ndeadlines = 0;
+        capture = 0;
+        Sigprocmask(SIG_SETMASK, &prev, NULL);
+        eval(line);
+        fflush(stdout);
+        _exit(laststatus);
+    }
+    close(fd[1]);
+    setpgid(pid, pid);
+    addjob(jobs, pid, FG, line);
+    Sigprocmask(SIG_SETMASK, &prev, NULL);
+
+    while (1) {
+        if (len == max) {
+            max = max ? 2 * max : SUBSTCHUNK;
+            if ((p = realloc(out, max)) == NULL) {
+                unix_error("substitute error");
+            }
+            out = p;
+        }
+        if ((n = read(fd[0], out + len, max - len)) < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        len += n;
+    }
+    close(fd[0]);
+    waitfg(pid);
+
+    ev = findevent(pid);
+    if (ev != NULL && (ev->stopped || ev->status == 128 + SIGINT
+                       || ev->status == 128 + SIGTSTP)) {
+        free(out);
+        return -1;
+    }
+    p = arenaalloc(len + 1);
+    memcpy(p, out, len);
+    p[len] = '\0';
+    free(out);
+    while (1) {
+        p += strspn(p, " \t\n");
+        if (*p == '\0') {
+            break;
+        }
+        addarg(av, p);
+        p += strcspn(p, " \t\n");
+        if (*p != '\0') {
+            *p++ = '\0';
+        }
+    }
+    return 0;
+}
+/*
+ * expand - Replace each $(...) of the command argv, stored by parseline()
+ *    as opsubst and its command line, by the words of its output,
+ *    running them from left to right, and each glob pattern, stored as
+ *    opglob and the pattern, by the sorted paths it matches, or by
+ *    itself if nothing matches. Returns the new argv, in the arena, or
+ *    NULL if a $(...) was stopped or killed by ctrl-c.
+ */
+char **expand(char **argv)
+{
+    struct argvec_t av;                 /* args being built */
+    int i;
+
+    for (i = 0; argv[i] != NULL && argv[i] != opsubst && argv[i] != opglob; i++) {
+        ;
+    }
+    if (argv[i] == NULL) {
+        return argv;                    /* nothing to run */
+    }
+    av.argc = 0;
+    av.max = MAXARGS;
+    av.argv = arenaalloc((av.max + 1) * sizeof(char *));
+    for (i = 0; argv[i] != NULL; i++) {
+        if (argv[i] == opglob) {
+            if (globword(&av, argv[++i]) == 0) {
+                addarg(&av, argv[i]);
+            }
+        } else if (argv[i] != opsubst) {
+            addarg(&av, argv[i]);
+        } else if (substitute(&av, argv[++i]) < 0) {
+            return NULL;
+        }
+    }
+    av.argv[av.argc] = NULL;
+    return av.argv;
+}
+/**************************
+ * end substitution routines
+ **************************/
+
+
+/************************************************************
+ * Helper routines for the environment. Variables live in an
+ * open addressing table hashed on their name. environ points
+ * at a sorted array of the same strings, which is rebuilt only
+ * after the table has changed, so launching a job passes it to
+ * execve() as it is. NAME=value words in front of a command
+ * get an overlay array of their own, in the command arena.
+ ************************************************************/
+
+/* initvars - Fill the variable table from the environment we got */
+void initvars(void)
+{
+    int i;
+
+    varslots = VARSINIT;
+    if ((vars = calloc(varslots, sizeof(char *))) == NULL) {
+        unix_error("initvars error");
+    }
+    for (i = 0; environ[i] != NULL; i++) {
+        if (strchr(environ[i], '=') != NULL) {
+            setvar(environ[i]);
+        }
+    }
+    rebuildenv();
+}
+
+/*
+ * varslot - Return the slot of vars holding the variable named by the
+ *    len bytes at name, or else the slot where it would go
+ */
+int varslot(const char *name, size_t len)
+{
+    unsigned long long h = fnv1a(14695981039346656037ULL, name, len);
+    int i, avail = -1;                  /* First tombstone on the way */
+
+    for (i = h & (varslots - 1); vars[i] != NULL; i = (i + 1) & (varslots - 1)) {
+        if (vars[i] == tombstone) {
+            if (avail < 0) {
+                avail = i;
+            }
+        }
+        else if (!strncmp(vars[i], name, len) && vars[i][len] == '=') {
+            return i;
+        }
+    }
+    return (avail >= 0) ? avail : i;
+}
+
+/*
+ * setvar - Set the variable of entry, a NAME=value string, to a copy of
+ *    it. The table is rehashed, which sweeps out the tombstones, when
+ *    it gets half full, and doubled if that would not free enough.
+ */
+void setvar(const char *entry)
+{
+    char **old = vars;
+    int oldslots = varslots, i, slot;
+
+    if (2 * (varsused + 1) > varslots) {
+        if (4 * (nvars + 1) > varslots) {
+            varslots *= 2;
+        }
+        if ((vars = calloc(varslots, sizeof(char *))) == NULL) {
+            unix_error("setvar error");
+        }
+        varsused = 0;
+        for (i = 0; i < oldslots; i++) {
+            if (old[i] != NULL && old[i] != tombstone) {
+                vars[varslot(old[i], strcspn(old[i], "="))] = old[i];
+                varsused++;
+            }
+        }
+        free(old);
+    }
+    slot = varslot(entry, strcspn(entry, "="));
+    if (vars[slot] == NULL || vars[slot] == tombstone) {
+        varsused += (vars[slot] == NULL);
+        nvars++;
+    }
+    else {
+        free(vars[slot]);
+    }
+    if ((vars[slot] = strdup(entry)) == NULL) {
+        unix_error("setvar error");
+    }
+}
+
+/* unsetvar - Remove the variable name, if there is one */
+void unsetvar(const char *name)
+{
+    int slot = varslot(name, strlen(name));
+
+    if (vars[slot] != NULL && vars[slot] != tombstone) {
+        free(vars[slot]);
+        vars[slot] = tombstone;
+        nvars--;
+    }
+}
+
+/* envcmp - Order environment strings for qsort() */
+static int envcmp(const void *a, const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/* rebuildenv - Rebuild envcache from the table and point environ at it */
+void rebuildenv(void)
+{
+    char **env;
+    int i, n = 0;
+
+    if ((env = realloc(envcache, (nvars + 1) * sizeof(char *))) == NULL) {
+        unix_error("rebuildenv error");
+    }
+    for (i = 0; i < varslots; i++) {
+        if (vars[i] != NULL && vars[i] != tombstone) {
+            env[n++] = vars[i];
+        }
+    }
+    qsort(env, n, sizeof(char *), envcmp);
+    env[n] = NULL;
+    envcache = environ = env;
+}
+
+/* isname - Are the len bytes at s a variable name? */
+int isname(const char *s, size_t len)
+{
+    size_t i;
+
+    if (len == 0 || isdigit((unsigned char)s[0])) {
+        return 0;
+    }
+    for (i = 0; i < len; i++) {
+        if (!isalnum((unsigned char)s[i]) && s[i] != '_') {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * assignlen - Return the length of the name if word is a NAME=value
+ *    assignment, else 0
+ */
+size_t assignlen(const char *word)
+{
+    char *eq = strchr(word, '=');
+
+    return (eq != NULL && isname(word, eq - word)) ? (size_t)(eq - word) : 0;
+}
+
+/*
+ * parseassigns - Take the NAME=value words in front of the command in
+ *    argv out of it. Returns the environment the command runs with:
+ *    environ if there were none, else an overlay in the arena holding
+ *    them and the variables they do not replace. If nothing follows
+ *    them they are exported instead, and NULL is returned.
+ */
+char **parseassigns(char **argv)
+{
+    char **envp;                        /* The overlay */
+    int i, j, k, n;                     /* Assignments, and indexes */
+    size_t len;
+
+    for (n = 0; argv[n] != NULL && assignlen(argv[n]) > 0; n++) {
+        ;
+    }
+    if (n == 0) {
+        return environ;
+    }
+    if (argv[n] == NULL) {
+        for (i = 0; i < n; i++) {
+            setvar(argv[i]);
+        }
+        rebuildenv();
+        laststatus = 0;
+        return NULL;
+    }
+
+    envp = arenaalloc((nvars + n + 1) * sizeof(char *));
+    memcpy(envp, argv, n * sizeof(char *));
+    k = n;
+    for (i = 0; environ[i] != NULL; i++) {
+        len = strcspn(environ[i], "=") + 1;
+        for (j = 0; j < n && strncmp(envp[j], environ[i], len); j++) {
+            ;
+        }
+        if (j == n) {                   /* not overridden */
+            envp[k++] = environ[i];
+        }
+    }
+    envp[k] = NULL;
+
+    for (i = 0; argv[i + n] != NULL; i++) {
+        argv[i] = argv[i + n];          /* shift the command down */
+    }
+    argv[i] = NULL;
+    return envp;
+}
+
+/*
+ * do_export - Execute the builtin export NAME=value ..., which sets
+ *    variables. A bare NAME is already exported if it is set, and
+ *    export alone lists the environment.
+ */
+void do_export(char **argv)
+{
+    int i, changed = 0;
+
+    if (argv[1] == NULL) {
+        for (i = 0; environ[i] != NULL; i++) {
+            printf("export %s\n", environ[i]);
+        }
+        return;
+    }
+    for (i = 1; argv[i] != NULL; i++) {
+        if (assignlen(argv[i]) > 0) {
+            setvar(argv[i]);
+            changed = 1;
+        }
+        else if (!isname(argv[i], strlen(argv[i]))) {
+            printf("%s: %s: not a valid identifier\n", argv[0], argv[i]);
+            laststatus = 1;
+        }
+    }
+    if (changed) {
+        rebuildenv();
+    }
+}
+
+/* do_unset - Execute the builtin unset NAME ..., which removes variables */
+void do_unset(char **argv)
+{
+    int i, changed = 0;
+
+    for (i = 1; argv[i] != NULL; i++) {
+        if (!isname(argv[i], strlen(argv[i]))) {
+            printf("%s: %s: not a valid identifier\n", argv[0], argv[i]);
+            laststatus = 1;
+            continue;
+        }
+        unsetvar(argv[i]);
+        changed = 1;
+    }
+    if (changed) {
+        rebuildenv();
+    }
+}
+/**************************
+ * end environment routines
+ **************************/
+
+
+/*******************************************************
+ * Helper routines that manage the job deadline min-heap.
+ * Callers block SIGALRM and SIGCHLD around them so they
+ * never race with sigalrm_handler or a job being reaped.
+ ******************************************************/
+
+/* nowms - Current CLOCK_MONOTONIC time in milliseconds */
+long nowms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+/*
+ * adddeadline - Schedule sig for job pid at time when and rearm the
+ *    timer. Returns -1 if the heap is full even without the deadlines
+ *    of reaped jobs, which a live job has at most one of.
+ */
+int adddeadline(long when, pid_t pid, int jid, int sig)
+{
+    struct deadline_t d = { when, pid, jid, sig };
+
+    if (reaped) {
+        prunedeadlines();
+    }
+    if (ndeadlines == MAXDEADLINES) {
+        return -1;
+    }
+    deadlines[ndeadlines++] = d;
+    siftdeadline(ndeadlines - 1);
+    armdeadline();
+    return 0;
+}
+
+/* popdeadline - Remove and return the earliest deadline */
+struct deadline_t popdeadline(void)
+{
+    struct deadline_t top = deadlines[0];
+
+    deadlines[0] = deadlines[--ndeadlines];
+    siftdeadline(0);
+    return top;
+}
+
+/* deldeadline - Cancel every deadline that matches pid, jid and sig */
+void deldeadline(pid_t pid, int jid, int sig)
+{
+    int i = 0;
+
+    while (i < ndeadlines) {
+        if (deadlines[i].pid == pid && deadlines[i].jid == jid && deadlines[i].sig == sig) {
+            deadlines[i] = deadlines[--ndeadlines];
+            siftdeadline(i);    /* recheck slot i, it holds a new entry */
+        } else {
+            i++;
+        }
+    }
+    armdeadline();
+}
+
+/*
+ * prunedeadlines - Cancel the deadlines of jobs that sigchld_handler has
+ *    reaped. Wakeups of wait (pid 0) belong to no job and stay.
+ */
+void prunedeadlines(void)
+{
+    struct job_t *job;          /* Job of the deadline at i */
+    int i = 0;
+
+    reaped = 0;
+    while (i < ndeadlines) {
+        job = getjobpid(jobs, deadlines[i].pid);
+        if (deadlines[i].pid != 0 && (job == NULL || job->jid != deadlines[i].jid)) {
+            deadlines[i] = deadlines[--ndeadlines];
+            siftdeadline(i);    /* recheck slot i, it holds a new entry */
+        } else {
+            i++;
+        }
+    }
+    armdeadline();
+}
+
+/* siftdeadline - Restore the heap order around an entry that was just placed at i */
+void siftdeadline(int i)
+{
+    int parent, child;
+    struct deadline_t d;
+
+    if (i >= ndeadlines) {
+        return;
+    }
+    d = deadlines[i];
+    /* sift up towards the root */
+    for (; i > 0 && deadlines[(parent = (i - 1) / 2)].when > d.when; i = parent) {
+        deadlines[i] = deadlines[parent];
+    }
+    /* then down towards the leaves */
+    for (; (child = 2 * i + 1) < ndeadlines; i = child) {
+        if (child + 1 < ndeadlines && deadlines[child + 1].when < deadlines[child].when) {
+            child++;
+        }
+        if (d.when <= deadlines[child].when) {
+            break;
+        }
+        deadlines[i] = deadlines[child];
+    }
+    deadlines[i] = d;
+}
+
+/* armdeadline - Set the interval timer to fire at the earliest deadline */
+void armdeadline(void)
+{
+    struct itimerval it;
+    long ms;
+
+    memset(&it, 0, sizeof(it));
+    if (ndeadlines > 0) {
+        ms = deadlines[0].when - nowms();
+        if (ms < 1) {
+            ms = 1;             /* already due, fire as soon as possible */
+        }
+        it.it_value.tv_sec = ms / 1000;
+        it.it_value.tv_usec = (ms % 1000) * 1000;
+    }
+    setitimer(ITIMER_REAL, &it, NULL);
+}
+/*********************************
+ * end job deadline helper routines
+ *********************************/
+
+
+/***********************
+ * Other helper routines
+ ***********************/
+
+/*
+ * usage - print a help message
+ */
+void usage(void)
+{
+    printf("Usage: shell [-hvpFo] [-n nice] [-N nice] [-s policy] [-c cmdline]\n");
+    printf("   -h   print this message\n");
+    printf("   -v   print additional diagnostic information\n");
+    printf("   -p   do not emit a command prompt\n");
+    printf("   -F   always fork and exec echo, true, false and printf\n");
+    printf("   -o   capture background output, see it with jobs -o or fg\n");
+    printf("   -n   nice level of background jobs (default 10)\n");
+    printf("   -N   nice level of the foreground job (default 0)\n");
+    printf("   -s   scheduling policy of background jobs: other, batch or idle\n");
+    printf("   -c   run cmdline and exit with its status instead of reading stdin\n");
+    exit(1);
+}
+
+/*
+ * unix_error - unix-style error routine
+ */
+void unix_error(char *msg)
+{
+    fprintf(stdout, "%s: %s\n", msg, strerror(errno));
+    exit(1);
+}
+
+/*
+ * app_error - application-style error routine
+ */
+void app_error(char *msg)
+{
+    fprintf(stdout, "%s\n", msg);
+    exit(1);
+}
+
+/*
+ * Signal - wrapper for the sigaction function
+ */
+handler_t *Signal(int signum, handler_t *handler)
+{
+    struct sigaction action, old_action;
+
+    action.sa_handler = handler;
+    sigemptyset(&action.sa_mask); /* block sigs of type being handled */
+    action.sa_flags = SA_RESTART; /* restart syscalls if possible */
+
+    if (sigaction(signum, &action, &old_action) < 0) {
+        unix_error("Signal error");
+    }
+    return (old_action.sa_handler);
+}
+
+/*
+ * sigquit_handler - The driver program can gracefully terminate the
+ *    child shell by sending it a SIGQUIT signal.
+ */
+void sigquit_handler(int sig)
+{
+    printf("Terminating after receipt of SIGQUIT signal\n");
+    exit(1);
 }
\ No newline at end of file
@@ -0,0 +1,42 @@
+/*
+ * tsh.h - What the tiny shell shares with programs linked against it
+ *
+ * tsh.c includes it, and so does tshbench.c, which is linked against
+ * tsh.c built with -DTSH_NOMAIN and reads the job list directly.
+ */
+#ifndef TSH_H
+#define TSH_H
+
+#include <sys/types.h>
+
+#define MAXLINE    1024   /* max line size */
+#define MAXJOBS      16   /* max jobs at any point in time */
+
+/* Job states */
+#define UNDEF 0 /* undefined */
+#define FG 1    /* running in foreground */
+#define BG 2    /* running in background */
+#define ST 3    /* stopped */
+
+struct job_t {              /* The job struct */
+    pid_t pid;              /* job PID */
+    int jid;                /* job ID [1, 2, ...] */
+    int state;              /* UNDEF, BG, FG, or ST */
+    int nice;               /* nice level of the job's process group */
+    char cmdline[MAXLINE];  /* command line */
+};
+extern struct job_t jobs[MAXJOBS]; /* The job list */
+
+/* Routines of tsh.c that tshbench times */
+int parseline(const char *cmdline, char ***argvp);
+void arenareset(void);
+void initjobs(struct job_t *jobs);
+int addjob(struct job_t *jobs, pid_t pid, int state, char *cmdline);
+int deletejob(struct job_t *jobs, pid_t pid);
+struct job_t *getjobpid(struct job_t *jobs, pid_t pid);
+int pid2jid(pid_t pid);
+void listjobs(struct job_t *jobs);
+ssize_t sio_puts(char s[]);
+ssize_t sio_putl(long v);
+
+#endif /* TSH_H */
@@ -0,0 +1,232 @@
+/*
+ * tshbench.c - Microbenchmarks of the shell's internal routines
+ *
+ * usage: tshbench [-r <reps>] [-w <warmup>]
+ *
+ * Linked against tsh.c built with -DTSH_NOMAIN. Times parseline(),
+ * the job list routines and the sio_* output routines in isolation,
+ * over a range of line lengths, argument counts and job list
+ * occupancies. Every case is warmed up with <warmup> batches, then
+ * timed over <reps> batches; a batch runs the routine often enough to
+ * take about BATCHNS ns. Reports the median, 90th and 99th percentile
+ * and minimum cost of one call. Output of the routines goes to
+ * /dev/null.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/types.h>
+#include "tsh.h"
+
+#define BATCHNS  200000   /* target length of a timed batch */
+
+char line[MAXLINE];         /* Command line for parseline */
+pid_t lastpid;              /* Last job in the list */
+int reps = 101;             /* Timed batches */
+int warmup = 5;             /* Untimed batches */
+FILE *out;                  /* Where the results go */
+
+double nowns(void);
+void fillline(int argc, int len);
+void filljobs(int n);
+void run(char *name, char *param, void (*fn)(long));
+static int dblcmp(const void *a, const void *b);
+
+/* The cases, each running its routine n times */
+void bparseline(long n)
+{
+    char **argv;
+
+    while (n-- > 0) {
+        arenareset();
+        parseline(line, &argv);
+    }
+}
+
+void baddjob(long n)
+{
+    while (n-- > 0) {
+        addjob(jobs, 99999, BG, "./myspin 1 &\n");
+        deletejob(jobs, 99999);
+    }
+}
+
+void bgetjobpid(long n)
+{
+    while (n-- > 0) {
+        getjobpid(jobs, lastpid);
+    }
+}
+
+void bgetjobmiss(long n)
+{
+    while (n-- > 0) {
+        getjobpid(jobs, 99999);
+    }
+}
+
+void bpid2jid(long n)
+{
+    while (n-- > 0) {
+        pid2jid(lastpid);
+    }
+}
+
+void blistjobs(long n)
+{
+    while (n-- > 0) {
+        listjobs(jobs);
+    }
+    fflush(stdout);
+}
+
+void bsioputs(long n)
+{
+    while (n-- > 0) {
+        sio_puts("Job [1] (12345) terminated by signal 2\n");
+    }
+}
+
+void bsioputl(long n)
+{
+    while (n-- > 0) {
+        sio_putl(1234567890L);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int sizes[][2] = { { 1, 16 }, { 8, 128 }, { 32, 512 }, { 128, 1000 } };
+    int occupancy[] = { 0, 4, 8, 15 };
+    char param[64];
+    int c, i;
+
+    while ((c = getopt(argc, argv, "r:w:")) != EOF) {
+        switch (c) {
+        case 'r':
+            reps = atoi(optarg);
+            break;
+        case 'w':
+            warmup = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-r <reps>] [-w <warmup>]\n", argv[0]);
+            exit(2);
+        }
+    }
+    if (reps < 1 || warmup < 0) {
+        fprintf(stderr, "Usage: %s [-r <reps>] [-w <warmup>]\n", argv[0]);
+        exit(2);
+    }
+
+    /* Results go to the real stdout, the routines' output to /dev/null */
+    out = fdopen(dup(STDOUT_FILENO), "w");
+    dup2(open("/dev/null", O_WRONLY), STDOUT_FILENO);
+    fprintf(out, "%-12s %-16s %10s %10s %10s %10s\n",
+            "routine", "case", "median ns", "p90 ns", "p99 ns", "min ns");
+
+    for (i = 0; i < 4; i++) {
+        fillline(sizes[i][0], sizes[i][1]);
+        snprintf(param, sizeof(param), "argc=%d len=%d", sizes[i][0], (int)strlen(line) - 1);
+        run("parseline", param, bparseline);
+    }
+    for (i = 0; i < 4; i++) {
+        filljobs(occupancy[i]);
+        snprintf(param, sizeof(param), "jobs=%d", occupancy[i]);
+        if (occupancy[i] < MAXJOBS) {
+            run("add+delete", param, baddjob);
+        }
+        if (occupancy[i] > 0) {
+            run("getjobpid", param, bgetjobpid);
+            run("pid2jid", param, bpid2jid);
+        }
+        snprintf(param, sizeof(param), "miss jobs=%d", occupancy[i]);
+        run("getjobpid", param, bgetjobmiss);
+        snprintf(param, sizeof(param), "jobs=%d", occupancy[i]);
+        run("listjobs", param, blistjobs);
+    }
+    run("sio_puts", "40 bytes", bsioputs);
+    run("sio_putl", "10 digits", bsioputl);
+    exit(0);
+}
+
+/* nowns - CLOCK_MONOTONIC time in ns */
+double nowns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* fillline - Make line a command line of argc words, about len bytes */
+void fillline(int argc, int len)
+{
+    int i, n = 0, w = len / argc - 1;
+
+    if (w < 1) {
+        w = 1;
+    }
+    for (i = 0; i < argc; i++) {
+        if (i > 0) {
+            line[n++] = ' ';
+        }
+        memset(line + n, (i == 0) ? '/' : 'a' + i % 26, w);
+        n += w;
+    }
+    strcpy(line + n, "\n");
+}
+
+/* filljobs - Make the job list hold n background jobs */
+void filljobs(int n)
+{
+    int i;
+
+    initjobs(jobs);
+    for (i = 0; i < n; i++) {
+        lastpid = 1000 + i;
+        addjob(jobs, lastpid, BG, "./myspin 1 &\n");
+    }
+}
+
+/*
+ * run - Time fn, calibrated to batches of about BATCHNS ns, and print a
+ *    line of results for it
+ */
+void run(char *name, char *param, void (*fn)(long))
+{
+    double *ns = malloc(reps * sizeof(double)), t;
+    long n;
+    int i;
+
+    for (n = 1; ; n *= 2) {             /* calibrate */
+        t = nowns();
+        fn(n);
+        if (nowns() - t >= BATCHNS || n >= (1L << 30)) {
+            break;
+        }
+    }
+    for (i = 0; i < warmup; i++) {
+        fn(n);
+    }
+    for (i = 0; i < reps; i++) {
+        t = nowns();
+        fn(n);
+        ns[i] = (nowns() - t) / n;
+    }
+    qsort(ns, reps, sizeof(double), dblcmp);
+    fprintf(out, "%-12s %-16s %10.1f %10.1f %10.1f %10.1f\n", name, param,
+            ns[reps / 2], ns[reps * 90 / 100], ns[reps * 99 / 100], ns[0]);
+    fflush(out);
+    free(ns);
+}
+
+static int dblcmp(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}